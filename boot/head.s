@@ -195,6 +195,13 @@ ignore_int:
  * I've tried to show which constants to change by having
  * some kind of marker at them (search for "16Mb"), but I
  * won't guarantee that's all :-( )
+ *
+ * Memory past 16Mb (up to 64Mb) is mapped later on, by
+ * paging_init() in mm/memory.c.
+ *
+ * If the cpu can do 4Mb pages (PSE), the 16Mb are mapped with
+ * four of those instead, which saves the kernel a lot of TLB
+ * entries. pg0-pg3 are then left unused.
  */
 .align 2
 setup_paging:
@@ -202,7 +209,32 @@ setup_paging:
 	xorl %eax,%eax
 	xorl %edi,%edi			/* pg_dir is at 0x000 */
 	cld;rep;stosl
-	movl $pg0+7,pg_dir		/* set present bit/user r/w */ /* 페이지 디렉터리에 페이지 테이블 매핑 및 플래그설정 */
+	pushfl				/* is there a cpuid? (can the ID bit change) */
+	popl %eax
+	movl %eax,%ecx
+	xorl $0x200000,%eax
+	pushl %eax
+	popfl
+	pushfl
+	popl %eax
+	pushl %ecx
+	popfl
+	xorl %ecx,%eax
+	testl $0x200000,%eax
+	jz 2f
+	movl $1,%eax
+	cpuid
+	testl $8,%edx			/* PSE */
+	jz 2f
+	movl %cr4,%eax
+	orl $0x10,%eax
+	movl %eax,%cr4
+	movl $0x000087,pg_dir		/* 4Mb page, present bit/user r/w */
+	movl $0x400087,pg_dir+4
+	movl $0x800087,pg_dir+8
+	movl $0xc00087,pg_dir+12
+	jmp 3f
+2:	movl $pg0+7,pg_dir		/* set present bit/user r/w */ /* 페이지 디렉터리에 페이지 테이블 매핑 및 플래그설정 */
 	movl $pg1+7,pg_dir+4		/*  --------- " " --------- */ /* 페이지 테이블당 4MB 그리고 16메가 필요하기 때문에 4번  */
 	movl $pg2+7,pg_dir+8		/*  --------- " " --------- */
 	movl $pg3+7,pg_dir+12		/*  --------- " " --------- */
@@ -216,11 +248,11 @@ setup_paging:
 	subl $0x1000,%eax   	/* 루프 수행마다 eax 값이 -4096 0x1000위치에서 -0x1000 을 하기때문에 멈춘다. */
 	jge 1b			/* eax 가 0이 되기 전 까지 반복 */
 	cld			/* 오름차순 플래그 셋팅 */
-	xorl %eax,%eax		/* pg_dir is at 0x0000 */
+3:	xorl %eax,%eax		/* pg_dir is at 0x0000 */
 	movl %eax,%cr3		/* cr3 - page directory start */
 	movl %cr0,%eax
-	orl $0x80000000,%eax
-	movl %eax,%cr0		/* set paging (PG) bit */
+	orl $0x80010000,%eax
+	movl %eax,%cr0		/* set paging (PG) and write-protect (WP) bits */
 	ret			/* this also flushes prefetch-queue */
 
 .align 2
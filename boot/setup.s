@@ -54,11 +54,60 @@ _start:
 	xor	%bh, %bh
 	int	$0x10		# save it in known place, con_init fetches
 	mov	%dx, %ds:0	# it from 0x90000.
-# Get memory size (extended mem, kB)
-
+# Get memory size (extended mem, kB). 0x88 can't see past 64Mb (and
+# often not past 16Mb), so we first ask e820 for the usable block at 1Mb,
+# then e801, and only then 0x88. The kernel can't use more than 63Mb
+# of extended memory (see mm/memory.c), which also makes it fit a word.
+
+	push	%ds			# e820 stores into es:di, es = INITSEG
+	pop	%es
+	xorl	%ebx, %ebx
+e820:
+	movl	$0xe820, %eax
+	movl	$0x534d4150, %edx	# "SMAP"
+	movl	$20, %ecx
+	mov	$0x1e0, %di		# 20 bytes free up to the root dev
+	int	$0x15
+	jc	e801
+	cmpl	$0x534d4150, %eax
+	jne	e801
+	cmpl	$1, %ds:0x1f0		# usable ram,
+	jne	1f
+	cmpl	$0x100000, %ds:0x1e0	# starting at 1Mb?
+	jne	1f
+	cmpl	$0, %ds:0x1e4
+	jne	1f
+	movl	$63*1024, %eax
+	cmpl	$0, %ds:0x1ec		# more than 4Gb, eh?
+	jne	got_mem
+	movl	%ds:0x1e8, %eax
+	shrl	$10, %eax
+	jmp	got_mem
+1:	testl	%ebx, %ebx		# last entry?
+	jnz	e820
+e801:
+	mov	$0xe801, %ax
+	xor	%cx, %cx
+	xor	%dx, %dx
+	int	$0x15
+	jc	no_e801
+	jcxz	1f			# some bioses only return ax/bx
+	mov	%cx, %ax
+	mov	%dx, %bx
+1:	movzwl	%bx, %ebx		# 64kB blocks above 16Mb
+	shll	$6, %ebx
+	movzwl	%ax, %eax		# kB between 1Mb and 16Mb
+	addl	%ebx, %eax
+	jmp	got_mem
+no_e801:
 	mov	$0x88, %ah 
 	int	$0x15
-	mov	%ax, %ds:2
+	movzwl	%ax, %eax
+got_mem:
+	cmpl	$63*1024, %eax
+	jbe	1f
+	movl	$63*1024, %eax
+1:	mov	%ax, %ds:2
 
 # Get video-card data:
 
@@ -138,6 +138,7 @@ void check_disk_change(int dev)
     
 	invalidate_inodes(dev);
 	invalidate_buffers(dev);
+	invalidate_dev_pages(dev);
 }
 
 #define _hashfn(dev,block) (((unsigned)(dev^block))%NR_HASH)
@@ -397,6 +398,41 @@ void bread_page(unsigned long address,int dev,int b[4])
     }
 }
 
+/*
+ * page_cached() tells if all the blocks of a page are in the cache and
+ * up to date, so that bread_page() on them won't have to wait.
+ */
+int page_cached(int dev,int b[4])
+{
+	struct buffer_head * bh;
+	int i;
+
+	for (i=0 ; i<4 ; i++) {
+		if (!b[i])
+			continue;
+		if (!(bh = find_buffer(dev,b[i])) || bh->b_lock || !bh->b_uptodate)
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * bread_page_ahead() starts reading the blocks of a page, but doesn't
+ * wait for them: a later bread_page() will find them in the cache.
+ */
+void bread_page_ahead(int dev,int b[4])
+{
+	struct buffer_head * bh;
+	int i;
+
+	for (i=0 ; i<4 ; i++)
+		if (b[i] && (bh = getblk(dev,b[i]))) {
+			if (!bh->b_uptodate)
+				ll_rw_block(READA,bh);
+			bh->b_count--;
+		}
+}
+
 /*
  * Ok, breada can be used as bread, but additionally to mark other
  * blocks for reading as well. End the argument list with a negative
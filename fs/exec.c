@@ -38,6 +38,33 @@ extern int sys_close(int fd);
  */
 #define MAX_ARG_PAGES 32
 
+/*
+ * EXEC_PREFETCH is the number of blocks of text and data we start
+ * reading ahead when a program is executed.
+ */
+#define EXEC_PREFETCH 64
+
+/*
+ * prefetch() starts reading in the first blocks of the new program,
+ * without waiting for them: the disk can work while we copy the
+ * arguments, and the first page faults find the blocks in the cache.
+ */
+static void prefetch(struct m_inode * inode, struct exec * ex)
+{
+	int nr[4];
+	int block,blocks,i;
+
+	blocks = (ex->a_text+ex->a_data+BLOCK_SIZE-1)/BLOCK_SIZE;
+	if (blocks > EXEC_PREFETCH)
+		blocks = EXEC_PREFETCH;
+/* remember that 1 block is used for header */
+	for (block=1 ; block<=blocks ; ) {
+		for (i=0 ; i<4 ; i++,block++)
+			nr[i] = (block<=blocks) ? bmap(inode,block) : 0;
+		bread_page_ahead(inode->i_dev,nr);
+	}
+}
+
 /*
  * create_tables() parses the env- and arg-strings in new user
  * memory and creates the pointer tables from them, and puts their
@@ -82,14 +109,18 @@ static unsigned long * create_tables(char * p,int argc,int envc)
  */
 static int count(char ** argv)
 {
-	int i=0;
-	char ** tmp;
-
-	if ((tmp = argv))
-		while (get_fs_long((unsigned long *) (tmp++)))
-			i++;
-
-	return i;
+	int __res,d0;
+
+	if (!argv)
+		return 0;
+	__asm__("push %%es ; push %%fs ; pop %%es\n\t"
+		"cld\n\t"
+		"repne ; scasl\n\t"
+		"pop %%es\n\t"
+		"notl %%ecx\n\t"
+		"decl %%ecx"
+		:"=c" (__res),"=D" (d0):"0" (0xffffffff),"1" (argv),"a" (0));
+	return __res;
 }
 
 /*
@@ -108,12 +139,15 @@ static int count(char ** argv)
  * We do this by playing games with the fs segment register.  Since it
  * it is expensive to load a segment register, we try to avoid calling
  * set_fs() unless we absolutely have to.
+ *
+ * Each string is measured with strnlen_fs() and then copied backwards a
+ * page-sized chunk at a time, rather than a byte at a time.
  */
 static unsigned long copy_strings(int argc,char ** argv,unsigned long *page,
 		unsigned long p, int from_kmem)
 {
-	char *tmp, *pag=NULL;
-	int len, offset = 0;
+	char *tmp;
+	unsigned long len, chunk;
 	unsigned long old_fs, new_fs;
 
 	if (!p)
@@ -131,36 +165,26 @@ static unsigned long copy_strings(int argc,char ** argv,unsigned long *page,
 			panic("argc is wrong");
 		if (from_kmem == 1)
 			set_fs(old_fs);
-		len=0;		/* remember zero-padding */
-
-		//len StringLength
-		do 
-		{
-			len++;
-		} while (get_fs_byte(tmp++));
-        // 페이지를 할당 받는 공간으로 추측
-
-		if (p-len < 0) 
+		/* len includes the zero-padding */
+		if (!(len = strnlen_fs(tmp,p))) 
 		{	/* this shouldn't happen - 128kB */
 			set_fs(old_fs);
 			return 0;
 		}
 		//argv[argc] 를 페이지 할당 받은 후 복사하는 부분
+		tmp += len;
 		while (len) 
 		{
-			--p; --tmp; --len;
-			if (--offset < 0) 
-			{
-				offset = p % PAGE_SIZE;//offset 4091
-				if (from_kmem==2)
-					set_fs(old_fs);
-				if (!(pag = (char *) page[p/PAGE_SIZE]) &&
-				    !(pag = (char *) (page[p/PAGE_SIZE] = get_free_page())) ) 
-					return 0;
-				if (from_kmem==2)
-					set_fs(new_fs);
+			chunk = (p-1) % PAGE_SIZE + 1;	/* room below p in its page */
+			if (chunk > len)
+				chunk = len;
+			p -= chunk; tmp -= chunk; len -= chunk;
+			if (!page[p/PAGE_SIZE] &&
+			    !(page[p/PAGE_SIZE] = get_free_page())) {
+				set_fs(old_fs);
+				return 0;
 			}
-			*(pag + offset) = get_fs_byte(tmp);
+			memcpy_fromfs((char *) page[p/PAGE_SIZE] + p%PAGE_SIZE,tmp,chunk);
 		}
 	}
 	if (from_kmem==2)
@@ -168,6 +192,11 @@ static unsigned long copy_strings(int argc,char ** argv,unsigned long *page,
 	return p;
 }
 
+/*
+ * change_ldt() sets up the new segments, and maps the argument pages
+ * just below the system call trampoline at the top of the data space.
+ * It returns the end of the argument pages.
+ */
 static unsigned long change_ldt(unsigned long text_size,unsigned long * page)
 {
 	unsigned long code_limit,data_limit,code_base,data_base;
@@ -176,8 +205,8 @@ static unsigned long change_ldt(unsigned long text_size,unsigned long * page)
 	//code_limit을 4K 단위로 맞춘다.
 	code_limit = text_size+PAGE_SIZE -1;
 	code_limit &= 0xFFFFF000;
-	// 베이스 어드레스를 프로세스 nr * 64M, 119p 참조 
-	data_limit = 0x4000000;//64M
+	// 베이스 어드레스는 모든 프로세스가 TASK_BASE 로 같다
+	data_limit = TASK_SIZE;
 	code_base = get_base(current->ldt[1]);
 	data_base = code_base;
 	set_base(current->ldt[1],code_base);
@@ -187,13 +216,14 @@ static unsigned long change_ldt(unsigned long text_size,unsigned long * page)
 /* make sure fs points to the NEW data segment */
 	//fs = 0x17
 	__asm__("pushl $0x17\n\tpop %%fs"::);
-	data_base += data_limit;
+	data_base += data_limit - PAGE_SIZE;
+	put_trampoline(data_base);
 	for (i=MAX_ARG_PAGES-1 ; i>=0 ; i--) {
 		data_base -= PAGE_SIZE;
 		if (page[i])
-			put_page(page[i],data_base);
+			put_dirty_page(page[i],data_base);
 	}
-	return data_limit;
+	return data_limit - PAGE_SIZE;
 }
 
 /*
@@ -217,7 +247,7 @@ int do_execve(unsigned long * eip,long tmp,char * filename,
 	unsigned long p=PAGE_SIZE*MAX_ARG_PAGES-4;
 
     // check code segment, 권한 체크
-	if ((0xffff & eip[1]) != 0x000f)
+	if (!(3 & eip[1]))
 		panic("execve called from supervisor mode");
 
 	for (i=0 ; i<MAX_ARG_PAGES ; i++)	/* clear page-table */
@@ -350,6 +380,7 @@ restart_interp:
 		retval = -ENOEXEC;
 		goto exec_error2;
 	}
+	prefetch(inode,&ex);
 
 	//쉘 스크립트가 아니면 
 	if (!sh_bang) 
@@ -381,6 +412,7 @@ restart_interp:
 	free_page_tables(get_base(current->ldt[1]),get_limit(0x0f));
 	//데이터 세그먼트 영역을 초기화.
 	free_page_tables(get_base(current->ldt[2]),get_limit(0x17));
+	exit_mmap(current);
 
 	//coprocess
 	if (last_task_used_math == current)
@@ -389,11 +421,11 @@ restart_interp:
 
 	//프로세스 LDT를 변경한다a
     // p = MAX_ARG_PAGES*PAGE_SIZE - 사용한 size
-    // p = (p) + (64MB) - (MAX_ARG_PAGES*PAGE_SIZE)  change_ldt
-    // p = ( MAX_ARG_PAGES*PAGE_SIZE - 사용한 size ) + (64MB) - (MAX_ARG_PAGES*PAGE_SIZE)  change_ldt
-    // p = ( MAX_ARG_PAGES*PAGE_SIZE)- 사용한 size  + (64MB) - (MAX_ARG_PAGES*PAGE_SIZE)  change_ldt
-    // p = ( MAX_ARG_PAGES*PAGE_SIZE) - (MAX_ARG_PAGES*PAGE_SIZE) + (64MB) - 사용한 size  change_ldt
-    // p = 64MB - 사용한 size
+    // p = (p) + (TASK_SIZE) - (MAX_ARG_PAGES*PAGE_SIZE)  change_ldt
+    // p = ( MAX_ARG_PAGES*PAGE_SIZE - 사용한 size ) + (TASK_SIZE) - (MAX_ARG_PAGES*PAGE_SIZE)  change_ldt
+    // p = ( MAX_ARG_PAGES*PAGE_SIZE)- 사용한 size  + (TASK_SIZE) - (MAX_ARG_PAGES*PAGE_SIZE)  change_ldt
+    // p = ( MAX_ARG_PAGES*PAGE_SIZE) - (MAX_ARG_PAGES*PAGE_SIZE) + (TASK_SIZE) - 사용한 size  change_ldt
+    // p = TASK_SIZE - 사용한 size
 	p += change_ldt(ex.a_text,page)-MAX_ARG_PAGES*PAGE_SIZE;
     // 파라미터와환경벼수 관리 포인터 테이블을 프로세스 스택공간에 만든다.
 	p = (unsigned long) create_tables((char *)p,argc,envc);
@@ -408,6 +440,7 @@ restart_interp:
 	while (i&0xfff)
 		put_fs_byte(0,(char *) (i++));
 	eip[0] = ex.a_entry;		/* eip, magic happens :-) */
+	eip[1] = 0x0f;			/* may have come from SYSCALL_CS */
 	eip[3] = p;			/* stack pointer */
 	return 0;
 exec_error2:
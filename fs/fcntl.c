@@ -70,6 +70,14 @@ int sys_fcntl(unsigned int fd, unsigned int cmd, unsigned long arg)
 			return 0;
 		case F_GETLK:	case F_SETLK:	case F_SETLKW:
 			return -1;
+		case F_SETPIPE_SZ:
+			if (!filp->f_inode->i_pipe)
+				return -EINVAL;
+			return pipe_resize(filp->f_inode,arg);
+		case F_GETPIPE_SZ:
+			if (!filp->f_inode->i_pipe)
+				return -EINVAL;
+			return PIPE_LEN(*filp->f_inode);
 		default:
 			return -1;
 	}
@@ -14,7 +14,7 @@
 #define MIN(a,b) (((a)<(b))?(a):(b))
 #define MAX(a,b) (((a)>(b))?(a):(b))
 
-int file_read(struct m_inode * inode, struct file * filp, char * buf, int count)
+int file_read(struct m_inode * inode, off_t * pos, char * buf, int count)
 {
 	int left,chars,nr;
 	struct buffer_head * bh;
@@ -24,7 +24,7 @@ int file_read(struct m_inode * inode, struct file * filp, char * buf, int count)
 
 	while ( left ) 
     {
-		if ( ( nr = bmap( inode, (filp->f_pos)/BLOCK_SIZE ) ) ) 
+		if ( ( nr = bmap( inode, (*pos)/BLOCK_SIZE ) ) ) 
         {
 			if ( !(bh=bread(inode->i_dev,nr)) )
 				break;
@@ -35,16 +35,15 @@ int file_read(struct m_inode * inode, struct file * filp, char * buf, int count)
 			bh = NULL;
         }
         
-		nr = filp->f_pos % BLOCK_SIZE;
+		nr = *pos % BLOCK_SIZE;
 		chars = MIN( BLOCK_SIZE-nr , left );    // 해당 블록에서 복사할 크기를 결정 한다.
-		filp->f_pos += chars;                   // file position을 변경
+		*pos += chars;                          // file position을 변경
 		left -= chars;                          // 해당 블록을 읽고 남은 크기를 계산
 
 		if ( bh )   // 디스크에서 데이터를 가져 왔으면 
         {
-			char * p = nr + bh->b_data;
-			while (chars-->0)
-				put_fs_byte(*(p++),buf++);
+			memcpy_tofs(buf,nr + bh->b_data,chars);
+			buf += chars;
 
 			brelse(bh);
 		} 
@@ -60,13 +59,30 @@ int file_read(struct m_inode * inode, struct file * filp, char * buf, int count)
 	return (count-left)?(count-left):-ERROR;
 }
 
-int file_write(struct m_inode * inode, struct file * filp, char * buf, int count)
+/*
+ * Is any of the user memory at buf an mmap() of the inode? Faulting it in
+ * means reading the file's blocks, so none of them may be kept locked.
+ */
+static int mapped_from(struct m_inode * inode, char * buf, int count)
+{
+	unsigned long start = (unsigned long) buf;
+	struct vm_area * vma;
+
+	for (vma = current->mmap ; vma < current->mmap + NR_VMA ; vma++)
+		if (vma->end && vma->inode == inode &&
+		    vma->start < start+count && start < vma->end)
+			return 1;
+	return 0;
+}
+
+int file_write(struct m_inode * inode, struct file * filp, off_t * ppos,
+	char * buf, int count)
 {
 	off_t pos;
 	int block,c;
 	struct buffer_head * bh;
 	char * p;
-	int i=0;
+	int i=0,fresh;
 
 /*
  * ok, append may not work when many processes are writing at the same time
@@ -75,17 +91,29 @@ int file_write(struct m_inode * inode, struct file * filp, char * buf, int count
 	if (filp->f_flags & O_APPEND)
 		pos = inode->i_size;
 	else
-		pos = filp->f_pos;
+		pos = *ppos;
+	invalidate_inode_pages(inode);
 
 	while ( i < count ) 
     {
 		if ( !(block = create_block( inode, pos/BLOCK_SIZE ) ) )
 			break;
 
-		if ( !(bh=bread(inode->i_dev,block)) )
+		c = pos % BLOCK_SIZE;       // block 내에 쓰기할 offset
+/*
+ * A block that is written all over needn't be read first. memcpy_fromfs()
+ * can sleep, though, so keep it locked until it really is up to date:
+ * bread() would think the old contents were good otherwise. That won't
+ * do if the copy may fault on this very file, so then just read it.
+ */
+		if ((fresh = (!c && count-i >= BLOCK_SIZE &&
+		    !mapped_from(inode,buf,BLOCK_SIZE)))) {
+			if ( !(bh=getblk(inode->i_dev,block)) )
+				break;
+			bh->b_lock = 1;
+		} else if ( !(bh=bread(inode->i_dev,block)) )
 			break;
 
-		c = pos % BLOCK_SIZE;       // block 내에 쓰기할 offset
 		p = c + bh->b_data;         // 쓰여질 버퍼의 메모리 주소
 		bh->b_dirt = 1;
 		c = BLOCK_SIZE - c;         // offset 부터 쓰기 때문에 
@@ -102,8 +130,13 @@ int file_write(struct m_inode * inode, struct file * filp, char * buf, int count
 
 		i += c;
 
-		while ( c-- > 0 )
-			*(p++) = get_fs_byte(buf++);
+		memcpy_fromfs(p,buf,c);
+		buf += c;
+		if (fresh) {
+			bh->b_uptodate = 1;
+			bh->b_lock = 0;
+			wake_up(&bh->b_wait);
+		}
 
 		brelse(bh);
 	}
@@ -111,7 +144,7 @@ int file_write(struct m_inode * inode, struct file * filp, char * buf, int count
 	inode->i_mtime = CURRENT_TIME;
 	if ( !(filp->f_flags & O_APPEND) ) 
     {
-		filp->f_pos = pos;
+		*ppos = pos;
 		inode->i_ctime = CURRENT_TIME;
 	}
 
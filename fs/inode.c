@@ -81,7 +81,7 @@ static int _bmap(struct m_inode * inode,int block,int create)
 	if ( block < 0 )
 		panic("_bmap: block<0");
 
-	if ( block >= (7 + 512 + 512*512) )
+	if ( block >= MAX_FILE_BLOCKS )
 		panic("_bmap: block>big");
 
     // 7 블록 이하 일때 
@@ -209,7 +209,7 @@ void iput(struct m_inode * inode)
 		wake_up(&inode->i_wait);
 		if (--inode->i_count)
 			return;
-		free_page(inode->i_size);
+		free_pipe_buffer(PIPE_BUFFER(*inode),PIPE_PAGES(*inode));
 		inode->i_count=0;
 		inode->i_dirt=0;
 		inode->i_pipe=0;
@@ -298,7 +298,7 @@ struct m_inode * get_pipe_inode(void)
 
 	if (!(inode = get_empty_inode()))
 		return NULL;
-	if (!(inode->i_size=get_free_page())) {//주소를 i_size에 얻어온다
+	if (!(inode->i_size=(unsigned long) alloc_pipe_buffer(1))) {//버퍼 주소를 i_size에 얻어온다
 		inode->i_count = 0;
 		return NULL;
 	}
@@ -306,6 +306,7 @@ struct m_inode * get_pipe_inode(void)
 	//#define PIPE_HEAD(inode) ((inode).i_zone[0])
     //#define PIPE_TAIL(inode) ((inode).i_zone[1])
     PIPE_HEAD(*inode) = PIPE_TAIL(*inode) = 0;//큐의 위치를 초기화
+	PIPE_PAGES(*inode) = 1;
 	inode->i_pipe = 1;
 	return inode;
 }
@@ -5,17 +5,141 @@
  */
 
 #include <signal.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
 
 #include <linux/sched.h>
+#include <linux/kernel.h>
 #include <linux/mm.h>	/* for get_free_page */
+#include <linux/ring.h>
 #include <asm/segment.h>
 
+extern int file_read(struct m_inode * inode, off_t * pos,
+		char * buf, int count);
+extern int file_write(struct m_inode * inode, struct file * filp,
+		off_t * pos, char * buf, int count);
+
+/*
+ * The copies in and out of a pipe can sleep (page faults, or disk i/o in
+ * sys_splice()), so they are done with the inode locked: that keeps
+ * pipe_resize() from changing the pages under them.
+ */
+static inline void lock_inode(struct m_inode * inode)
+{
+	cli();
+	while (inode->i_lock)
+		sleep_on(&inode->i_wait);
+	inode->i_lock=1;
+	sti();
+}
+
+static inline void unlock_inode(struct m_inode * inode)
+{
+	inode->i_lock=0;
+	wake_up(&inode->i_wait);
+}
+
+/*
+ * The pages of a pipe aren't contiguous, so the spans that ring.h gives
+ * are cut at page boundaries as well.
+ */
+static int put_span(struct m_inode * inode, char ** p)
+{
+	unsigned long head = PIPE_HEAD(*inode);
+	unsigned long n = ring_put_span(head,PIPE_TAIL(*inode),PIPE_LEN(*inode));
+	unsigned long offset = head & (PAGE_SIZE-1);
+
+	if (n > PAGE_SIZE-offset)
+		n = PAGE_SIZE-offset;
+	*p = offset + (char *) PIPE_BUFFER(*inode)->page[head/PAGE_SIZE];
+	return n;
+}
+
+static int get_span(struct m_inode * inode, char ** p)
+{
+	unsigned long tail = PIPE_TAIL(*inode);
+	unsigned long n = ring_get_span(PIPE_HEAD(*inode),tail,PIPE_LEN(*inode));
+	unsigned long offset = tail & (PAGE_SIZE-1);
+
+	if (n > PAGE_SIZE-offset)
+		n = PAGE_SIZE-offset;
+	*p = offset + (char *) PIPE_BUFFER(*inode)->page[tail/PAGE_SIZE];
+	return n;
+}
+
+struct pipe_buffer * alloc_pipe_buffer(int pages)
+{
+	struct pipe_buffer * buf;
+	int i;
+
+	if (!(buf = malloc(sizeof(struct pipe_buffer))))
+		return NULL;
+	for (i=0 ; i<pages ; i++)
+		if (!(buf->page[i] = get_free_page())) {
+			free_pipe_buffer(buf,i);
+			return NULL;
+		}
+	return buf;
+}
+
+void free_pipe_buffer(struct pipe_buffer * buf, int pages)
+{
+	while (pages-- > 0)
+		free_page(buf->page[pages]);
+	free_s(buf,sizeof(struct pipe_buffer));
+}
+
+/*
+ * pipe_resize() gives the pipe a new ring of at least 'size' bytes (a
+ * power of two pages), and moves what is in the old one to it. It
+ * returns the new size, or -EBUSY if the data wouldn't fit.
+ */
+int pipe_resize(struct m_inode * inode, int size)
+{
+	struct pipe_buffer * buf, * old;
+	int pages, old_pages, to, chars;
+	char * p;
+
+	if (size <= 0 || size > PIPE_MAX_PAGES*PAGE_SIZE)
+		return -EINVAL;
+	for (pages = 1 ; pages*PAGE_SIZE < size ; pages <<= 1)
+		/* nothing */ ;
+	if (!(buf = alloc_pipe_buffer(pages)))
+		return -ENOMEM;
+	lock_inode(inode);
+	if (PIPE_SIZE(*inode) >= pages*PAGE_SIZE) {
+		unlock_inode(inode);
+		free_pipe_buffer(buf,pages);
+		return -EBUSY;
+	}
+	to = 0;
+	while ((chars = get_span(inode,&p))) {
+		if (chars > PAGE_SIZE - (to & (PAGE_SIZE-1)))
+			chars = PAGE_SIZE - (to & (PAGE_SIZE-1));
+		memcpy((to & (PAGE_SIZE-1)) + (char *) buf->page[to/PAGE_SIZE],
+			p,chars);
+		ring_advance(PIPE_TAIL(*inode),chars,PIPE_LEN(*inode));
+		to += chars;
+	}
+	old = PIPE_BUFFER(*inode);
+	old_pages = PIPE_PAGES(*inode);
+	inode->i_size = (unsigned long) buf;
+	PIPE_PAGES(*inode) = pages;
+	PIPE_TAIL(*inode) = 0;
+	PIPE_HEAD(*inode) = to;
+	unlock_inode(inode);
+	free_pipe_buffer(old,old_pages);
+	return pages*PAGE_SIZE;
+}
+
 int read_pipe(struct m_inode * inode, char * buf, int count)
 {
-	int chars, size, read = 0;
+	int chars, read = 0;
+	char * p;
 
 	while (count>0) {
-		while (!(size=PIPE_SIZE(*inode))) { //파이프에 데이터가 있으면, 
+		while (!PIPE_SIZE(*inode)) { //파이프에 데이터가 있으면, 
 			wake_up(&inode->i_wait);//write 를 runnable로
 			if (inode->i_count != 2) /* are there any writers? */
 				return read;//쓰는프로세스가 없으면 리턴
@@ -23,28 +147,18 @@ int read_pipe(struct m_inode * inode, char * buf, int count)
                                      // 파이프에 데이터를 쓰는 프로세스로 전환된다.
                                      // schedule에서 write가 깨어남
 		}
-		chars = PAGE_SIZE-PIPE_TAIL(*inode);// 오버플로우 전까지 읽을 수 있는양
-		if (chars > count)// 읽어야 하는 양이 더 작은경우(오버플로우 아님)
-			chars = count;
-        else
-        {
-        }    // 오버플로우 발생
-
-		if (chars > size)// size: 쓰여져있는 값이 더 작은경우(오버플로우 아님)
-			chars = size;
-        else
-        {   // 오버플로우 발생
-        }
-        
-		count -= chars;// 다음번에 읽을값
-		read += chars;
-		size = PIPE_TAIL(*inode);//읽을 위치
-		PIPE_TAIL(*inode) += chars;//읽은 후의 위치
-		PIPE_TAIL(*inode) &= (PAGE_SIZE-1);//오버플로우 보정
-        // if(PIPE_TAIL(*inode) == (PAGE_SIZE)) 
-        //    PIPE_TAIL(*inode) = 0 이 된다
-		while (chars-->0)// chars: 이시점에서 읽을 값
-			put_fs_byte(((char *)inode->i_size)[size++],buf++);
+		// 페이지 안에서 이어진 만큼씩 한꺼번에 사용자 버퍼로 복사
+		lock_inode(inode);
+		while (count>0 && (chars = get_span(inode,&p))) {
+			if (chars > count)
+				chars = count;
+			memcpy_tofs(buf,p,chars);
+			ring_advance(PIPE_TAIL(*inode),chars,PIPE_LEN(*inode));
+			count -= chars;// 다음번에 읽을값
+			read += chars;
+			buf += chars;
+		}
+		unlock_inode(inode);
 	}
 	wake_up(&inode->i_wait);
 	return read;
@@ -52,10 +166,11 @@ int read_pipe(struct m_inode * inode, char * buf, int count)
 	
 int write_pipe(struct m_inode * inode, char * buf, int count)
 {
-	int chars, size, written = 0;
+	int chars, written = 0;
+	char * p;
 
 	while (count>0) {
-		while (!(size=(PAGE_SIZE-1)-PIPE_SIZE(*inode))) {//쓸 공간을 계산
+		while (PIPE_FULL(*inode)) {//쓸 공간이 없으면
 			wake_up(&inode->i_wait);// read 를 깨워준다
 			if (inode->i_count != 2) { /* no readers */
 				current->signal |= (1<<(SIGPIPE-1));// write_pipe에만 signal이 있고 read_pipe에는 없다
@@ -64,23 +179,133 @@ int write_pipe(struct m_inode * inode, char * buf, int count)
 			sleep_on(&inode->i_wait);
 		}
         // read_pipe 와 유사한 처리
-		chars = PAGE_SIZE-PIPE_HEAD(*inode);//head > tail 
-		if (chars > count)
-			chars = count;
-		if (chars > size)
-			chars = size;
-		count -= chars;
-		written += chars;
-		size = PIPE_HEAD(*inode);
-		PIPE_HEAD(*inode) += chars;
-		PIPE_HEAD(*inode) &= (PAGE_SIZE-1);
-		while (chars-->0)
-			((char *)inode->i_size)[size++]=get_fs_byte(buf++);
+		lock_inode(inode);
+		while (count>0 && (chars = put_span(inode,&p))) {
+			if (chars > count)
+				chars = count;
+			memcpy_fromfs(p,buf,chars);
+			ring_advance(PIPE_HEAD(*inode),chars,PIPE_LEN(*inode));
+			count -= chars;
+			written += chars;
+			buf += chars;
+		}
+		unlock_inode(inode);
 	}
 	wake_up(&inode->i_wait);
 	return written;
 }
 
+/*
+ * splice_to_pipe() reads the file straight into the pipe's pages, and
+ * splice_from_pipe() writes the file straight from them: file_read() and
+ * file_write() copy to and from the buffer cache through fs, so pointing
+ * fs at kernel data is all it takes.
+ */
+static int splice_to_pipe(struct file * in, struct m_inode * pipe, int len)
+{
+	struct m_inode * inode = in->f_inode;
+	unsigned long old_fs;
+	int chars, done = 0;
+	char * p;
+
+	old_fs = get_fs();
+	set_fs(get_ds());
+	while (len>0 && in->f_pos < inode->i_size) {
+		while (PIPE_FULL(*pipe)) {
+			wake_up(&pipe->i_wait);
+			if (pipe->i_count != 2) { /* no readers */
+				current->signal |= (1<<(SIGPIPE-1));
+				if (!done)
+					done = -1;
+				goto out;
+			}
+			sleep_on(&pipe->i_wait);
+		}
+		lock_inode(pipe);
+		if ((chars = put_span(pipe,&p))) {
+			if (chars > len)
+				chars = len;
+			if (chars > inode->i_size - in->f_pos)
+				chars = inode->i_size - in->f_pos;
+			if ((chars = file_read(inode,&in->f_pos,p,chars)) > 0)
+				ring_advance(PIPE_HEAD(*pipe),chars,PIPE_LEN(*pipe));
+		}
+		unlock_inode(pipe);
+		if (chars < 0) {
+			if (!done)
+				done = chars;
+			break;
+		}
+		len -= chars;
+		done += chars;
+	}
+out:
+	set_fs(old_fs);
+	wake_up(&pipe->i_wait);
+	return done;
+}
+
+/* this one returns as soon as the pipe is empty, once it has done some */
+static int splice_from_pipe(struct m_inode * pipe, struct file * out, int len)
+{
+	struct m_inode * inode = out->f_inode;
+	unsigned long old_fs;
+	int chars, done = 0;
+	char * p;
+
+	old_fs = get_fs();
+	set_fs(get_ds());
+	while (len>0) {
+		while (!PIPE_SIZE(*pipe)) {
+			wake_up(&pipe->i_wait);
+			if (done || pipe->i_count != 2)
+				goto out;
+			sleep_on(&pipe->i_wait);
+		}
+		lock_inode(pipe);
+		if ((chars = get_span(pipe,&p))) {
+			if (chars > len)
+				chars = len;
+			if ((chars = file_write(inode,out,&out->f_pos,p,chars)) > 0)
+				ring_advance(PIPE_TAIL(*pipe),chars,PIPE_LEN(*pipe));
+		}
+		unlock_inode(pipe);
+		if (chars < 0) {
+			if (!done)
+				done = chars;
+			break;
+		}
+		len -= chars;
+		done += chars;
+	}
+out:
+	set_fs(old_fs);
+	wake_up(&pipe->i_wait);
+	return done;
+}
+
+/*
+ * sys_splice() moves up to len bytes between a pipe and a regular file,
+ * at the file's current position, without going through user space.
+ */
+int sys_splice(unsigned int fd_in, unsigned int fd_out, int len)
+{
+	struct file * in, * out;
+
+	if (fd_in >= NR_OPEN || !(in = current->filp[fd_in]) ||
+	    fd_out >= NR_OPEN || !(out = current->filp[fd_out]))
+		return -EBADF;
+	if (!(in->f_mode & 1) || !(out->f_mode & 2))
+		return -EBADF;
+	if (len < 0)
+		return -EINVAL;
+	if (in->f_inode->i_pipe && S_ISREG(out->f_inode->i_mode))
+		return splice_from_pipe(in->f_inode,out,len);
+	if (out->f_inode->i_pipe && S_ISREG(in->f_inode->i_mode))
+		return splice_to_pipe(in,out->f_inode,len);
+	return -EINVAL;
+}
+
 int sys_pipe(unsigned long * fildes)
 {
 	struct m_inode * inode;
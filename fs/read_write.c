@@ -7,6 +7,7 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include <linux/kernel.h>
 #include <linux/sched.h>
@@ -17,10 +18,10 @@ extern int read_pipe(struct m_inode * inode, char * buf, int count);
 extern int write_pipe(struct m_inode * inode, char * buf, int count);
 extern int block_read(int dev, off_t * pos, char * buf, int count);
 extern int block_write(int dev, off_t * pos, char * buf, int count);
-extern int file_read(struct m_inode * inode, struct file * filp,
+extern int file_read(struct m_inode * inode, off_t * pos,
 		char * buf, int count);
 extern int file_write(struct m_inode * inode, struct file * filp,
-		char * buf, int count);
+		off_t * pos, char * buf, int count);
 
 int sys_lseek(unsigned int fd,off_t offset, int origin)
 {
@@ -56,44 +57,37 @@ int sys_lseek(unsigned int fd,off_t offset, int origin)
 	return file->f_pos;
 }
 
-int sys_read(unsigned int fd,char * buf,int count)
+/*
+ * do_read() is sys_read() after the argument checks: the buffer has been
+ * verified already. It reads at *pos, which is &file->f_pos except for
+ * pread().
+ */
+static int do_read(struct file * file, char * buf, int count, off_t * pos)
 {
-	struct file * file;
-	struct m_inode * inode;
-
-	if ( ( fd >= NR_OPEN ) ||   // fd 값이 정상적인지
-         ( count < 0 ) ||       // 읽을 바이트수가 정상적인지
-         !(file = current->filp[fd])) // 열려 있는 fd 인지
-		return -EINVAL;
-
-	if ( !count )   // 읽을 크기가 0이면
-		return 0;
+	struct m_inode * inode = file->f_inode;
 
-	verify_area(buf,count);
-    
-	inode = file->f_inode;
     // read pipe 를 호출
 	if (inode->i_pipe)
 		return (file->f_mode&1)?read_pipe(inode,buf,count):-EIO;
 
 	if (S_ISCHR(inode->i_mode))
-		return rw_char(READ,inode->i_zone[0],buf,count,&file->f_pos);
+		return rw_char(READ,inode->i_zone[0],buf,count,pos);
 
 	if (S_ISBLK(inode->i_mode))
-		return block_read(inode->i_zone[0],&file->f_pos,buf,count);
+		return block_read(inode->i_zone[0],pos,buf,count);
 
     // 디렉토리거나 일반파일 이면
 	if ( S_ISDIR(inode->i_mode) || S_ISREG(inode->i_mode) ) 
     {
         // 읽을 사이즈 보다 읽을 파일의 남은 사이즈가 더 클때 
         // 읽을 사이즈를 보정한다.
-		if ( ( count + file->f_pos ) > inode->i_size )
-			count = inode->i_size - file->f_pos;
+		if ( ( count + *pos ) > inode->i_size )
+			count = inode->i_size - *pos;
 
 		if ( count <= 0 )
 			return 0;
 
-		return file_read(inode,file,buf,count);
+		return file_read(inode,pos,buf,count);
 	}
 
 	printk("(Read)inode->i_mode=%06o\n\r",inode->i_mode);
@@ -101,24 +95,219 @@ int sys_read(unsigned int fd,char * buf,int count)
 	return -EINVAL;
 }
 
-int sys_write(unsigned int fd,char * buf,int count)
+int sys_read(unsigned int fd,char * buf,int count)
 {
 	struct file * file;
-	struct m_inode * inode;
-	
-	if (fd>=NR_OPEN || count <0 || !(file=current->filp[fd]))
+
+	if ( ( fd >= NR_OPEN ) ||   // fd 값이 정상적인지
+         ( count < 0 ) ||       // 읽을 바이트수가 정상적인지
+         !(file = current->filp[fd])) // 열려 있는 fd 인지
 		return -EINVAL;
-	if (!count)
+
+	if ( !count )   // 읽을 크기가 0이면
 		return 0;
-	inode=file->f_inode;
+
+	if (verify_area(buf,count))
+		return -EFAULT;
+	return do_read(file,buf,count,&file->f_pos);
+}
+
+/*
+ * do_write() is sys_write() after the argument checks, writing at *pos.
+ * sys_sendfile() uses it too, with fs pointing at kernel data.
+ */
+static int do_write(struct file * file, char * buf, int count, off_t * pos)
+{
+	struct m_inode * inode = file->f_inode;
+
 	if (inode->i_pipe)
 		return (file->f_mode&2)?write_pipe(inode,buf,count):-EIO;
 	if (S_ISCHR(inode->i_mode))
-		return rw_char(WRITE,inode->i_zone[0],buf,count,&file->f_pos);
+		return rw_char(WRITE,inode->i_zone[0],buf,count,pos);
 	if (S_ISBLK(inode->i_mode))
-		return block_write(inode->i_zone[0],&file->f_pos,buf,count);
+		return block_write(inode->i_zone[0],pos,buf,count);
 	if (S_ISREG(inode->i_mode))
-		return file_write(inode,file,buf,count);
+		return file_write(inode,file,pos,buf,count);
 	printk("(Write)inode->i_mode=%06o\n\r",inode->i_mode);
 	return -EINVAL;
 }
+
+int sys_write(unsigned int fd,char * buf,int count)
+{
+	struct file * file;
+	
+	if (fd>=NR_OPEN || count <0 || !(file=current->filp[fd]))
+		return -EINVAL;
+	if (!count)
+		return 0;
+	return do_write(file,buf,count,&file->f_pos);
+}
+
+/*
+ * sys_sendfile() copies count bytes of a regular file, from *offset (or
+ * the file position, if offset is NULL), to any file it could write().
+ * The data goes straight from the source's buffer cache blocks to the
+ * writer, without a trip through user space. It has one argument more
+ * than fit in registers, so they are all passed in a block in user
+ * memory: out_fd, in_fd, offset, count.
+ */
+int sys_sendfile(unsigned long * args)
+{
+	static char zero_block[BLOCK_SIZE];
+	struct file * in, * out;
+	struct m_inode * inode;
+	struct buffer_head * bh;
+	unsigned long out_fd, in_fd, old_fs;
+	off_t * offset, pos;
+	int count, chars, nr, done = 0;
+
+	out_fd = get_fs_long(args);
+	in_fd = get_fs_long(args+1);
+	offset = (off_t *) get_fs_long(args+2);
+	count = get_fs_long(args+3);
+	if (out_fd >= NR_OPEN || !(out = current->filp[out_fd]) ||
+	    in_fd >= NR_OPEN || !(in = current->filp[in_fd]))
+		return -EBADF;
+	if (!(in->f_mode & 1) || !(out->f_mode & 2))
+		return -EBADF;
+	inode = in->f_inode;
+	if (!S_ISREG(inode->i_mode) || count < 0)
+		return -EINVAL;
+	if (offset) {
+		if (verify_area(offset,sizeof(off_t)))
+			return -EFAULT;
+		pos = get_fs_long((unsigned long *) offset);
+		if (pos < 0)
+			return -EINVAL;
+	} else
+		pos = in->f_pos;
+	if (count > (int) (inode->i_size - pos))
+		count = inode->i_size - pos;
+	old_fs = get_fs();
+	set_fs(get_ds());
+	while (count > 0) {
+		if ((nr = bmap(inode,pos/BLOCK_SIZE))) {
+			if (!(bh = bread(inode->i_dev,nr)))
+				break;
+		} else
+			bh = NULL;
+		nr = pos % BLOCK_SIZE;
+		chars = BLOCK_SIZE - nr;
+		if (chars > count)
+			chars = count;
+		chars = do_write(out,nr + (bh ? bh->b_data : zero_block),chars,
+			&out->f_pos);
+		brelse(bh);
+		if (chars <= 0) {
+			if (!done)
+				done = chars;
+			break;
+		}
+		pos += chars;
+		count -= chars;
+		done += chars;
+	}
+	set_fs(old_fs);
+	if (offset)
+		put_fs_long(pos,(unsigned long *) offset);
+	else
+		in->f_pos = pos;
+	inode->i_atime = CURRENT_TIME;
+	return done;
+}
+
+/*
+ * readv() and writev() go through the iovec array here, with one
+ * do_read() or do_write() per segment, and stop at the first short one.
+ */
+static int do_readv_writev(int rw, unsigned int fd, struct iovec * iov,
+	int iovcnt)
+{
+	struct file * file;
+	char * buf;
+	int i, len, chars, total = 0;
+
+	if (fd >= NR_OPEN || !(file = current->filp[fd]))
+		return -EBADF;
+	if (iovcnt < 0 || iovcnt > UIO_MAXIOV)
+		return -EINVAL;
+	for (i = 0 ; i < iovcnt ; i++) {
+		len = get_fs_long((unsigned long *) &iov[i].iov_len);
+		if (len < 0 || total + len < 0)
+			return -EINVAL;
+		total += len;
+	}
+	total = 0;
+	for (i = 0 ; i < iovcnt ; i++) {
+		buf = (char *) get_fs_long((unsigned long *) &iov[i].iov_base);
+		if (!(len = get_fs_long((unsigned long *) &iov[i].iov_len)))
+			continue;
+		if (rw == READ) {
+			if (verify_area(buf,len))
+				chars = -EFAULT;
+			else
+				chars = do_read(file,buf,len,&file->f_pos);
+		} else
+			chars = do_write(file,buf,len,&file->f_pos);
+		if (chars < 0)
+			return total ? total : chars;
+		total += chars;
+		if (chars < len)
+			break;
+	}
+	return total;
+}
+
+int sys_readv(unsigned int fd, struct iovec * iov, int iovcnt)
+{
+	return do_readv_writev(READ,fd,iov,iovcnt);
+}
+
+int sys_writev(unsigned int fd, struct iovec * iov, int iovcnt)
+{
+	return do_readv_writev(WRITE,fd,iov,iovcnt);
+}
+
+/*
+ * pread() and pwrite() read and write at the offset they are given, and
+ * leave the file position alone. Like sys_sendfile(), they get their
+ * four arguments in a block: fd, buf, count, offset.
+ */
+static int do_pread_pwrite(int rw, unsigned long * args)
+{
+	struct file * file;
+	unsigned int fd;
+	char * buf;
+	int count;
+	off_t pos;
+
+	fd = get_fs_long(args);
+	buf = (char *) get_fs_long(args+1);
+	count = get_fs_long(args+2);
+	pos = get_fs_long(args+3);
+	if (fd >= NR_OPEN || !(file = current->filp[fd]))
+		return -EBADF;
+	if (file->f_inode->i_pipe)
+		return -ESPIPE;
+	if (count < 0 || pos < 0 || pos > MAX_FILE_BLOCKS*BLOCK_SIZE ||
+	    count > MAX_FILE_BLOCKS*BLOCK_SIZE - pos)
+		return -EINVAL;
+	if (!count)
+		return 0;
+	if (rw == READ) {
+		if (verify_area(buf,count))
+			return -EFAULT;
+		return do_read(file,buf,count,&pos);
+	}
+	return do_write(file,buf,count,&pos);
+}
+
+int sys_pread(unsigned long * args)
+{
+	return do_pread_pwrite(READ,args);
+}
+
+int sys_pwrite(unsigned long * args)
+{
+	return do_pread_pwrite(WRITE,args);
+}
@@ -12,12 +12,13 @@
 #include <linux/kernel.h>
 #include <asm/segment.h>
 
-static void cp_stat(struct m_inode * inode, struct stat * statbuf)
+static int cp_stat(struct m_inode * inode, struct stat * statbuf)
 {
 	struct stat tmp;
 	int i;
 
-	verify_area(statbuf,sizeof (* statbuf));
+	if (verify_area(statbuf,sizeof (* statbuf)))
+		return -EFAULT;
 	tmp.st_dev = inode->i_dev;
 	tmp.st_ino = inode->i_num;
 	tmp.st_mode = inode->i_mode;
@@ -31,17 +32,19 @@ static void cp_stat(struct m_inode * inode, struct stat * statbuf)
 	tmp.st_ctime = inode->i_ctime;
 	for (i=0 ; i<sizeof (tmp) ; i++)
 		put_fs_byte(((char *) &tmp)[i],&((char *) statbuf)[i]);
+	return 0;
 }
 
 int sys_stat(char * filename, struct stat * statbuf)
 {
 	struct m_inode * inode;
+	int error;
 
 	if (!(inode=namei(filename)))
 		return -ENOENT;
-	cp_stat(inode,statbuf);
+	error = cp_stat(inode,statbuf);
 	iput(inode);
-	return 0;
+	return error;
 }
 
 int sys_fstat(unsigned int fd, struct stat * statbuf)
@@ -51,6 +54,5 @@ int sys_fstat(unsigned int fd, struct stat * statbuf)
 
 	if (fd >= NR_OPEN || !(f=current->filp[fd]) || !(inode=f->f_inode))
 		return -EBADF;
-	cp_stat(inode,statbuf);
-	return 0;
+	return cp_stat(inode,statbuf);
 }
@@ -58,6 +58,7 @@ void truncate(struct m_inode * inode)
 
 	if (!(S_ISREG(inode->i_mode) || S_ISDIR(inode->i_mode)))
 		return;
+	invalidate_inode_pages(inode);
 
 	for (i=0;i<7;i++)
     {
@@ -22,6 +22,71 @@ static inline unsigned long get_fs_long(const unsigned long *addr)
 	return _v;
 }
 
+/*
+ * strnlen_fs() returns the length of the string at fs:s including the
+ * terminating null, or 0 if there is no null within the first max bytes.
+ */
+static inline unsigned long strnlen_fs(const char * s, unsigned long max)
+{
+	unsigned long _v;
+	int d0;
+
+	if (!max)
+		return 0;
+	__asm__("push %%es ; push %%fs ; pop %%es\n\t"
+		"cld\n\t"
+		"repne ; scasb\n\t"
+		"pop %%es\n\t"
+		"je 1f\n\t"
+		"movl %4,%%ecx\n"
+		"1:\tnegl %%ecx\n\t"
+		"addl %4,%%ecx"
+		:"=c" (_v),"=D" (d0):"0" (max),"1" (s),"r" (max),"a" (0));
+	return _v;
+}
+
+/*
+ * memcpy_fromfs() copies n bytes from fs:from to the kernel.
+ */
+static inline void memcpy_fromfs(void * to, const void * from, unsigned long n)
+{
+	int d0,d1,d2,d3;
+
+	__asm__("push %%ds ; push %%fs ; pop %%ds\n\t"
+		"cld\n\t"
+		"movl %%ecx,%%eax\n\t"
+		"shrl $2,%%ecx\n\t"
+		"rep ; movsl\n\t"
+		"movl %%eax,%%ecx\n\t"
+		"andl $3,%%ecx\n\t"
+		"rep ; movsb\n\t"
+		"pop %%ds"
+		:"=c" (d0),"=D" (d1),"=S" (d2),"=a" (d3)
+		:"0" (n),"1" (to),"2" (from)
+		:"memory");
+}
+
+/*
+ * memcpy_tofs() copies n bytes from the kernel to fs:to.
+ */
+static inline void memcpy_tofs(void * to, const void * from, unsigned long n)
+{
+	int d0,d1,d2,d3;
+
+	__asm__("push %%es ; push %%fs ; pop %%es\n\t"
+		"cld\n\t"
+		"movl %%ecx,%%eax\n\t"
+		"shrl $2,%%ecx\n\t"
+		"rep ; movsl\n\t"
+		"movl %%eax,%%ecx\n\t"
+		"andl $3,%%ecx\n\t"
+		"rep ; movsb\n\t"
+		"pop %%es"
+		:"=c" (d0),"=D" (d1),"=S" (d2),"=a" (d3)
+		:"0" (n),"1" (to),"2" (from)
+		:"memory");
+}
+
 static inline void put_fs_byte(char val,char *addr)
 {
 __asm__ ("movb %0,%%fs:%1"::"r" (val),"m" (*addr));
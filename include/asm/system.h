@@ -19,6 +19,48 @@ __asm__ ("movl %%esp,%%eax\n\t" \
 
 #define iret() __asm__ ("iret"::)
 
+/* keeps gcc from moving memory accesses across it */
+#define barrier() __asm__ __volatile__("":::"memory")
+
+/* for code that may be called with interrupts off as well as on */
+#define save_flags(x) \
+__asm__ __volatile__("pushfl ; popl %0":"=r" (x))
+
+#define restore_flags(x) \
+__asm__ __volatile__("pushl %0 ; popfl"::"r" (x):"memory")
+
+/*
+ * cpuid only exists on later 486's and up: has_cpuid() checks if the
+ * ID-flag (bit 21) in eflags can be toggled.
+ */
+#define has_cpuid() ({ \
+unsigned long __f1,__f2; \
+__asm__("pushfl\n\t" \
+	"pushfl\n\t" \
+	"popl %0\n\t" \
+	"movl %0,%1\n\t" \
+	"xorl $0x200000,%0\n\t" \
+	"pushl %0\n\t" \
+	"popfl\n\t" \
+	"pushfl\n\t" \
+	"popl %0\n\t" \
+	"popfl" \
+	:"=&r" (__f1),"=&r" (__f2)); \
+(__f1 ^ __f2) & 0x200000; })
+
+#define cpuid(op,a,b,c,d) \
+__asm__("cpuid":"=a" (a),"=b" (b),"=c" (c),"=d" (d):"0" (op))
+
+#define wrmsr(msr,lo,hi) \
+__asm__ __volatile__("wrmsr"::"c" (msr),"a" (lo),"d" (hi))
+
+#define clts() __asm__ ("clts"::)
+#define stts() \
+__asm__ ("movl %%cr0,%%eax\n\t" \
+	"orl $8,%%eax\n\t" \
+	"movl %%eax,%%cr0" \
+	:::"ax")
+
 #define _set_gate(gate_addr,type,dpl,addr) \
 __asm__ ("movw %%dx,%%ax\n\t" \
 	"movw %0,%%dx\n\t" \
@@ -6,6 +6,13 @@
  * root-device by changing the line ROOT_DEV = XXX in boot/bootsect.s
  */
 
+/*
+ * Define SWAP_DEV to the device to swap to, eg 0x0302 for /dev/hd2. It
+ * has to be a hard disk partition or the ram disk, and has to carry a
+ * swap-space bitmap (see mm/swap.c). Leave it undefined for no swapping.
+ */
+/* #define SWAP_DEV 0x0302 */
+
 /*
  * define your keyboard here -
  * KBD_FINNISH for Finnish keyboards
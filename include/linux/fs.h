@@ -48,6 +48,7 @@ void buffer_init(long buffer_end);
 #define NR_BUFFERS nr_buffers
 #define BLOCK_SIZE 1024
 #define BLOCK_SIZE_BITS 10
+#define MAX_FILE_BLOCKS (7+512+512*512)	/* direct, indirect, double */
 #ifndef NULL
 #define NULL ((void *) 0)
 #endif
@@ -55,13 +56,25 @@ void buffer_init(long buffer_end);
 #define INODES_PER_BLOCK ((BLOCK_SIZE)/(sizeof (struct d_inode)))
 #define DIR_ENTRIES_PER_BLOCK ((BLOCK_SIZE)/(sizeof (struct dir_entry)))
 
+/*
+ * A pipe is a ring (see <linux/ring.h>) of PIPE_LEN bytes, kept in the
+ * pages of the pipe_buffer at i_size. It starts out as one page, and
+ * fcntl(F_SETPIPE_SZ) can make it up to PIPE_MAX_PAGES.
+ */
+#define PIPE_MAX_PAGES 16
+
+struct pipe_buffer {
+	unsigned long page[PIPE_MAX_PAGES];
+};
+
+#define PIPE_BUFFER(inode) ((struct pipe_buffer *) (inode).i_size)
 #define PIPE_HEAD(inode) ((inode).i_zone[0])
 #define PIPE_TAIL(inode) ((inode).i_zone[1])
-#define PIPE_SIZE(inode) ((PIPE_HEAD(inode)-PIPE_TAIL(inode))&(PAGE_SIZE-1))// 사용하고 있는 파이프 사이즈, overflow 처리방법?
+#define PIPE_PAGES(inode) ((inode).i_zone[2])
+#define PIPE_LEN(inode) (PIPE_PAGES(inode)*PAGE_SIZE)
+#define PIPE_SIZE(inode) ring_chars(PIPE_HEAD(inode),PIPE_TAIL(inode),PIPE_LEN(inode))// 사용하고 있는 파이프 사이즈
 #define PIPE_EMPTY(inode) (PIPE_HEAD(inode)==PIPE_TAIL(inode))
-#define PIPE_FULL(inode) (PIPE_SIZE(inode)==(PAGE_SIZE-1))//1 개는 빼고 써야, empty/full을 구분할 수 있다
-#define INC_PIPE(head) \
-__asm__("incl %0\n\tandl $4095,%0"::"m" (head))
+#define PIPE_FULL(inode) (!ring_left(PIPE_HEAD(inode),PIPE_TAIL(inode),PIPE_LEN(inode)))//1 개는 빼고 써야, empty/full을 구분할 수 있다
 
 typedef char buffer_block[BLOCK_SIZE];
 
@@ -183,12 +196,18 @@ extern void iput(struct m_inode * inode);
 extern struct m_inode * iget(int dev,int nr);
 extern struct m_inode * get_empty_inode(void);
 extern struct m_inode * get_pipe_inode(void);
+extern struct pipe_buffer * alloc_pipe_buffer(int pages);
+extern void free_pipe_buffer(struct pipe_buffer * buf, int pages);
+extern int pipe_resize(struct m_inode * inode, int size);
 extern struct buffer_head * get_hash_table(int dev, int block);
 extern struct buffer_head * getblk(int dev, int block);
 extern void ll_rw_block(int rw, struct buffer_head * bh);
+extern int ll_rw_page(int rw, int dev, int nr, char * buffer);
 extern void brelse(struct buffer_head * buf);
 extern struct buffer_head * bread(int dev,int block);
 extern void bread_page(unsigned long addr,int dev,int b[4]);
+extern int page_cached(int dev,int b[4]);
+extern void bread_page_ahead(int dev,int b[4]);
 extern struct buffer_head * breada(int dev,int block,...);
 extern int new_block(int dev);
 extern void free_block(int dev, int block);
@@ -1,7 +1,7 @@
 /*
  * 'kernel.h' contains some often-used function prototypes etc
  */
-void verify_area(void * addr,int count);
+int verify_area(void * addr,int count);
 void panic(const char * str);
 int printf(const char * fmt, ...);
 int printk(const char * fmt, ...);
@@ -11,6 +11,12 @@ void free_s(void * obj, int size);
 
 #define free(x) free_s((x), 0)
 
+struct kmem_cache;
+struct kmem_cache * kmem_cache_create(const char * name, unsigned int size,
+	unsigned int align, void (*ctor)(void *));
+void * kmem_cache_alloc(struct kmem_cache * cache, int priority);
+void kmem_cache_free(struct kmem_cache * cache, void * obj);
+
 /*
  * This is defined as a macro, but at some point this might become a
  * real subroutine that sets a flag if it returns true (to do
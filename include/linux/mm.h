@@ -3,8 +3,95 @@
 
 #define PAGE_SIZE 4096
 
-extern unsigned long get_free_page(void);
+/* these are not to be changed without changing head.s etc */
+#define LOW_MEM 0x100000
+#define PAGING_MEMORY (63*1024*1024)
+#define PAGING_PAGES (PAGING_MEMORY>>12)
+#define MAP_NR(addr) (((addr)-LOW_MEM)>>12)
+#define USED 100
+
+/*
+ * Every task has a page directory of its own. The kernel's identity
+ * mapping of the first 64Mb is shared by all of them, and user space is
+ * the TASK_SIZE bytes above it: all tasks use the same segment base.
+ */
+#define TASK_BASE 0x4000000
+#define TASK_SIZE 0xc0000000
+
+/* the system call trampoline page and its code segment - see <unistd.h> */
+#define SYSCALL_TRAMPOLINE (TASK_SIZE-PAGE_SIZE)
+#define SYSCALL_CS 0x1b
+#define dir_entry(p,address) \
+((unsigned long *) ((p)->tss.cr3 + (((address)>>20) & 0xffc)))
+
+#define PAGE_PRESENT	0x01
+#define PAGE_RW		0x02
+#define PAGE_USER	0x04
+#define PAGE_ACCESSED	0x20
+#define PAGE_DIRTY	0x40
+
+#define invalidate() \
+__asm__("movl %%cr3,%%eax\n\tmovl %%eax,%%cr3":::"ax")
+
+extern unsigned char mem_map [ PAGING_PAGES ];
+
+/*
+ * GFP_ATOMIC allocations never sleep, and may be done from interrupts:
+ * they just fail if there is no free page. GFP_KERNEL ones may shrink
+ * the page cache or swap to get one.
+ */
+#define GFP_ATOMIC	0x01
+#define GFP_KERNEL	0x02
+
+extern unsigned long __get_free_page(int priority);
+#define get_free_page() __get_free_page(GFP_KERNEL)
 extern unsigned long put_page(unsigned long page,unsigned long address);
+extern unsigned long put_dirty_page(unsigned long page,unsigned long address);
+extern unsigned long put_trampoline(unsigned long address);
 extern void free_page(unsigned long addr);
 
+/* page_ops.c */
+extern void (*copy_page)(unsigned long from, unsigned long to);
+extern void (*clear_page)(unsigned long page);
+extern void page_ops_init(void);
+
+struct task_struct;
+extern int resident_pages(struct task_struct * p);
+
+struct m_inode;
+extern void invalidate_inode_pages(struct m_inode * inode);
+extern void invalidate_dev_pages(int dev);
+extern void unmap_page_range(unsigned long from, unsigned long size);
+
+/*
+ * The mmap()ed areas of a task are kept in its task_struct, like its open
+ * files. Addresses are in the task's segment, like brk and start_stack,
+ * and an area with end == 0 is free. Areas are put from MMAP_BASE up,
+ * and at most MMAP_TOP - which leaves 16Mb for the stack.
+ */
+#define NR_VMA 16
+#define MMAP_BASE 0x40000000
+#define MMAP_TOP(p) (((p)->start_stack - 0x1000000) & 0xfffff000)
+
+struct vm_area {
+	unsigned long start, end;
+	struct m_inode * inode;		/* NULL for anonymous memory */
+	unsigned long offset;		/* in the file, of 'start' */
+	unsigned short prot, flags;
+};
+
+/* mmap.c */
+extern struct vm_area * find_vma(struct task_struct * p, unsigned long addr);
+extern int vma_overlap(struct task_struct * p, unsigned long start,
+	unsigned long end);
+extern void exit_mmap(struct task_struct * p);
+
+/* swap.c */
+extern int swap_dev;
+extern void init_swapping(void);
+extern int swap_out(void);
+extern int swap_in(unsigned long * table_ptr);
+extern int swap_fork(unsigned long * from, unsigned long * to);
+extern void swap_free(int swap_nr);
+
 #endif
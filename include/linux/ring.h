@@ -0,0 +1,75 @@
+#ifndef _RING_H
+#define _RING_H
+
+/*
+ * A ring is a buffer of 'size' bytes (a power of two) with a head index,
+ * where the producer puts data, and a tail index, where the consumer
+ * takes it. One byte is always left unused, so that head==tail means the
+ * ring is empty. The tty queues and pipes are rings.
+ *
+ * One producer and one consumer may run at the same time - one of them
+ * at interrupt level, say - without cli(): only the producer moves head
+ * and only the consumer moves tail, and ring_advance() moves an index
+ * only after the data it covers has been written or read. Anything else
+ * (two producers, or taking back data from the head like the tty erase
+ * code does) still needs interrupts off.
+ *
+ * ring_put_span() and ring_get_span() give the length of the contiguous
+ * piece that can be written at head or read at tail, so that bulk copies
+ * can use whatever copy routine fits (memcpy, memcpy_fromfs, ...), which
+ * is what ring_put() and ring_get() do.
+ */
+
+#include <asm/system.h>
+
+#define ring_chars(head,tail,size) (((head)-(tail))&((size)-1))
+#define ring_left(head,tail,size) (((tail)-(head)-1)&((size)-1))
+
+#define ring_advance(index,n,size) \
+do { barrier(); (index) = ((index)+(n))&((size)-1); } while (0)
+
+static inline unsigned long ring_put_span(unsigned long head,
+	unsigned long tail, unsigned long size)
+{
+	unsigned long left = ring_left(head,tail,size);
+
+	return (left < size-head) ? left : size-head;
+}
+
+static inline unsigned long ring_get_span(unsigned long head,
+	unsigned long tail, unsigned long size)
+{
+	unsigned long chars = ring_chars(head,tail,size);
+
+	return (chars < size-tail) ? chars : size-tail;
+}
+
+/*
+ * ring_put() and ring_get() copy up to n bytes into or out of the ring
+ * with copy(to,from,n), and return how many they did.
+ */
+#define ring_put(buf,size,head,tail,from,n,copy) ({ \
+unsigned long __n = (n), __done = 0, __span; \
+const char * __from = (from); \
+while (__n && (__span = ring_put_span((head),(tail),(size)))) { \
+	if (__span > __n) \
+		__span = __n; \
+	copy((buf)+(head),__from,__span); \
+	ring_advance((head),__span,(size)); \
+	__from += __span; __done += __span; __n -= __span; \
+} \
+__done; })
+
+#define ring_get(buf,size,head,tail,to,n,copy) ({ \
+unsigned long __n = (n), __done = 0, __span; \
+char * __to = (to); \
+while (__n && (__span = ring_get_span((head),(tail),(size)))) { \
+	if (__span > __n) \
+		__span = __n; \
+	copy(__to,(buf)+(tail),__span); \
+	ring_advance((tail),__span,(size)); \
+	__to += __span; __done += __span; __n -= __span; \
+} \
+__done; })
+
+#endif
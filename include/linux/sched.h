@@ -26,7 +26,8 @@
 #define NULL ((void *) 0)
 #endif
 
-extern int copy_page_tables(unsigned long from, unsigned long to, long size);
+extern int copy_page_tables(unsigned long from, unsigned long to, long size,
+	struct task_struct * p);
 extern int free_page_tables(unsigned long from, unsigned long size);
 
 extern void sched_init(void);
@@ -93,6 +94,7 @@ struct task_struct {
 	unsigned short gid,egid,sgid;
 	long alarm;
 	long utime,stime,cutime,cstime,start_time;
+	long min_flt,maj_flt,cow_flt,cmin_flt,cmaj_flt,ccow_flt;
 	unsigned short used_math;
 /* file system info */
 	int tty;		/* -1 if no tty, so it must be signed */
@@ -104,10 +106,24 @@ struct task_struct {
 	struct file * filp[NR_OPEN];
 /* ldt for this task 0 - zero 1 - cs 2 - ds&ss */
 	struct desc_struct ldt[3];
-/* tss for this task */
+/* saved kernel esp/eip, fs/gs, ldt selector and math state for this task */
 	struct tss_struct tss;
+	struct vm_area mmap[NR_VMA];
 };
 
+/*
+ *  INIT_TSS is the one hardware TSS all tasks share. Only esp0/ss0 and the
+ * io-bitmap offset are ever looked at by the cpu, as tasks are switched in
+ * software (see switch_to below) - esp0 is updated on every switch.
+ */
+#define INIT_TSS \
+	{0,PAGE_SIZE+(long)&init_task,0x10,0,0,0,0,(long)&pg_dir,\
+	 0,0,0,0,0,0,0,0, \
+	 0,0,0x17,0x17,0x17,0x17,0x17,0x17, \
+	 _LDT(0),0x80000000, \
+		{} \
+	}
+
 /*
  *  INIT_TASK is used to set up the first task table, touch at
  * your own risk!. Base=0, limit=0x9ffff (=640kB)
@@ -119,6 +135,7 @@ struct task_struct {
 /* pid etc.. */	0,-1,0,0,0, \
 /* uid etc */	0,0,0,0,0,0, \
 /* alarm */	0,0,0,0,0,0, \
+/* faults */	0,0,0,0,0,0, \
 /* math */	0, \
 /* fs info */	-1,0022,NULL,NULL,NULL,0, \
 /* filp */	{NULL,}, \
@@ -127,15 +144,11 @@ struct task_struct {
 /* ldt */	{0x9f,0xc0fa00}, \
 		{0x9f,0xc0f200}, \
 	}, \
-/*tss*/	{0,PAGE_SIZE+(long)&init_task,0x10,0,0,0,0,(long)&pg_dir,\
-	 0,0,0,0,0,0,0,0, \
-	 0,0,0x17,0x17,0x17,0x17,0x17,0x17, \
-	 _LDT(0),0x80000000, \
-		{} \
-	}, \
+/*tss*/	INIT_TSS, \
 }
 
 extern struct task_struct *task[NR_TASKS];
+extern struct tss_struct init_tss;
 extern struct task_struct *last_task_used_math;
 extern struct task_struct *current;
 extern long volatile jiffies;
@@ -167,32 +180,41 @@ __asm__("str %%ax\n\t" \
 /*
  *	switch_to(n) should switch tasks to task nr n, first
  * checking that n isn't the current task, in which case it does nothing.
- * This also clears the TS-flag if the task we switched to has used
- * tha math co-processor latest.
- */
-/* https://stackoverflow.com/questions/33783692/what-does-the-ljmp-instruction-do-in-the-linux-kernel-fork-system-call
- * 1. switch 할 프로세스가 현재 프로세스면 종료
- * 2. dx 를 __tmp.b 에 저장
- * 3. 현재프로세스와 ecx 교환, task[n] 을 현재 프로세스로 변경
- * 4. ljmp tss[n]
- * 5. 보조 프로세스를 사용여부 확인
- * 6. 사용않하면 1로 점프 
- *    아니면 CR0 의 task 변경 플래그 클리어
+ *
+ * There is no hardware task switch: all tasks run on the one init_tss, and
+ * switching is just a matter of saving the callee-saved registers and the
+ * flags on the old kernel stack, swapping stacks, and letting __switch_to()
+ * fix up esp0, the ldt, fs/gs and the TS-flag (so that math_state_restore
+ * still gets called lazily on the first math instruction). A task that has
+ * never run yet has tss.eip pointing to ret_from_fork instead of 1: below.
  */
-// tss 을 restore 되면서 interrupt 설정이 그이전 으로 변경 된다
+extern void __switch_to(struct task_struct * prev, struct task_struct * next)
+	__attribute__((regparm(2)));
+
 #define switch_to(n) {\
-struct {long a,b;} __tmp; \
-__asm__("cmpl %%ecx,current\n\t" \
-	"je 1f\n\t" \
-	"movw %%dx,%1\n\t" \
-	"xchgl %%ecx,current\n\t" \
-	"ljmp *%0\n\t" \
-	"cmpl %%ecx,last_task_used_math\n\t" \
-	"jne 1f\n\t" \
-	"clts\n" \
-	"1:" \
-	::"m" (*&__tmp.a),"m" (*&__tmp.b), \
-	"d" (_TSS(n)),"c" ((long) task[n])); \
+struct task_struct * __prev = current, * __next = task[n]; \
+long __d0,__d1; \
+if (__next != __prev) \
+__asm__ __volatile__("pushfl\n\t" \
+	"pushl %%ebp\n\t" \
+	"pushl %%edi\n\t" \
+	"pushl %%esi\n\t" \
+	"pushl %%ebx\n\t" \
+	"movl %%esp,%0\n\t" \
+	"movl $1f,%1\n\t" \
+	"movl %4,%%esp\n\t" \
+	"pushl %5\n\t" \
+	"jmp __switch_to\n" \
+	"1:\tpopl %%ebx\n\t" \
+	"popl %%esi\n\t" \
+	"popl %%edi\n\t" \
+	"popl %%ebp\n\t" \
+	"popfl" \
+	:"=m" (__prev->tss.esp),"=m" (__prev->tss.eip), \
+	 "=a" (__d0),"=d" (__d1) \
+	:"m" (__next->tss.esp),"m" (__next->tss.eip), \
+	 "2" (__prev),"3" (__next) \
+	:"cx","memory"); \
 }
 
 #define PAGE_ALIGN(n) (((n)+0xfff)&0xfffff000)
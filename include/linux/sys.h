@@ -72,6 +72,15 @@ extern int sys_setreuid();
 extern int sys_setregid();
 extern int sys_iam();
 extern int sys_whoami();
+extern int sys_vtimes();
+extern int sys_splice();
+extern int sys_sendfile();
+extern int sys_readv();
+extern int sys_writev();
+extern int sys_pread();
+extern int sys_pwrite();
+extern int sys_mmap();
+extern int sys_munmap();
 
 fn_ptr sys_call_table[] = { sys_setup, sys_exit, sys_fork, sys_read,
 sys_write, sys_open, sys_close, sys_waitpid, sys_creat, sys_link,
@@ -85,4 +94,6 @@ sys_getgid, sys_signal, sys_geteuid, sys_getegid, sys_acct, sys_phys,
 sys_lock, sys_ioctl, sys_fcntl, sys_mpx, sys_setpgid, sys_ulimit,
 sys_uname, sys_umask, sys_chroot, sys_ustat, sys_dup2, sys_getppid,
 sys_getpgrp, sys_setsid, sys_sigaction, sys_sgetmask, sys_ssetmask,
-sys_setreuid,sys_setregid, sys_iam, sys_whoami };
+sys_setreuid,sys_setregid, sys_iam, sys_whoami, sys_vtimes, sys_splice,
+sys_sendfile, sys_readv, sys_writev, sys_pread, sys_pwrite,
+sys_mmap, sys_munmap };
@@ -10,9 +10,11 @@
 #define _TTY_H
 
 #include <termios.h>
+#include <linux/ring.h>
 
 #define TTY_BUF_SIZE 1024
 
+/* a tty_queue is a ring, see <linux/ring.h> */
 struct tty_queue {
 	unsigned long data;
 	unsigned long head;
@@ -24,14 +26,14 @@ struct tty_queue {
 #define INC(a) ((a) = ((a)+1) & (TTY_BUF_SIZE-1))
 #define DEC(a) ((a) = ((a)-1) & (TTY_BUF_SIZE-1))
 #define EMPTY(a) ((a).head == (a).tail)
-#define LEFT(a) (((a).tail-(a).head-1)&(TTY_BUF_SIZE-1))
+#define LEFT(a) ring_left((a).head,(a).tail,TTY_BUF_SIZE)
 #define LAST(a) ((a).buf[(TTY_BUF_SIZE-1)&((a).head-1)])
 #define FULL(a) (!LEFT(a))
-#define CHARS(a) (((a).head-(a).tail)&(TTY_BUF_SIZE-1))
+#define CHARS(a) ring_chars((a).head,(a).tail,TTY_BUF_SIZE)
 #define GETCH(queue,c) \
-(void)({c=(queue).buf[(queue).tail];INC((queue).tail);})
+(void)({c=(queue).buf[(queue).tail];ring_advance((queue).tail,1,TTY_BUF_SIZE);})
 #define PUTCH(c,queue) \
-(void)({(queue).buf[(queue).head]=(c);INC((queue).head);})
+(void)({(queue).buf[(queue).head]=(c);ring_advance((queue).head,1,TTY_BUF_SIZE);})
 
 #define INTR_CHAR(tty) ((tty)->termios.c_cc[VINTR])
 #define QUIT_CHAR(tty) ((tty)->termios.c_cc[VQUIT])
@@ -44,4 +44,5 @@ extern inline char * strtok(char * s,const char * ct);
 extern inline void * memcpy(void * dest,const void * src, int n);
 extern inline void * memmove(void * dest,const void * src, int n);
 extern inline void * memchr(const void * cs,char c,int count);
+extern inline void * memset(void * s,char c,int count);
 #endif
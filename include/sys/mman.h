@@ -0,0 +1,24 @@
+#ifndef _MMAN_H
+#define _MMAN_H
+
+#include <sys/types.h>
+
+#define PROT_NONE	0
+#define PROT_READ	1
+#define PROT_WRITE	2
+#define PROT_EXEC	4
+
+#define MAP_SHARED	0x01
+#define MAP_PRIVATE	0x02
+#define MAP_TYPE	0x0f
+#define MAP_FIXED	0x10
+#define MAP_ANONYMOUS	0x20	/* no file: zero-filled memory */
+#define MAP_ANON	MAP_ANONYMOUS
+
+#define MAP_FAILED	((void *) -1)
+
+extern void * mmap(void * addr, size_t len, int prot, int flags,
+	int fildes, off_t off);
+extern int munmap(void * addr, size_t len);
+
+#endif
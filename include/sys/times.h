@@ -10,6 +10,22 @@ struct tms {
 	time_t tms_cstime;
 };
 
+/*
+ * struct vtms is what vtimes() returns: the times, plus what the process
+ * and its waited-for children did to memory.
+ */
+struct vtms {
+	struct tms vt_tms;
+	long vt_minflt;		/* page faults that didn't have to read the disk */
+	long vt_majflt;		/* page faults that did */
+	long vt_cowflt;		/* copy-on-write breaks */
+	long vt_cminflt;
+	long vt_cmajflt;
+	long vt_ccowflt;
+	long vt_rss;		/* pages resident now */
+};
+
 extern time_t times(struct tms * tp);
+extern time_t vtimes(struct vtms * tp);
 
 #endif
@@ -0,0 +1,17 @@
+#ifndef _UIO_H
+#define _UIO_H
+
+#include <sys/types.h>
+
+/* readv() and writev() take an array of these */
+struct iovec {
+	void * iov_base;
+	size_t iov_len;
+};
+
+#define UIO_MAXIOV	1024	/* most iovecs in one call */
+
+extern int readv(int fildes, const struct iovec * iov, int iovcnt);
+extern int writev(int fildes, const struct iovec * iov, int iovcnt);
+
+#endif
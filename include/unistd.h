@@ -131,12 +131,36 @@
 #define __NR_setregid	71
 #define __NR_iam		72
 #define __NR_whoami		73
+#define __NR_vtimes		74
+#define __NR_splice		75
+#define __NR_sendfile	76
+#define __NR_readv		77
+#define __NR_writev		78
+#define __NR_pread		79
+#define __NR_pwrite		80
+#define __NR_mmap		81
+#define __NR_munmap		82
+
+/*
+ * Every exec'd program has the kernel's system call trampoline mapped
+ * read-only at 0xbffff000, the top page of its address space. It
+ * uses sysenter if the cpu has it and int 0x80 otherwise, so the stubs
+ * just call it - far, through the 0x1b code segment that covers only that
+ * page (SYSCALL_CS in <linux/mm.h>), as the program's own cs stops at the
+ * end of its code. The kernel's own user-mode code (init and lib/) runs before any execve and
+ * can't see it, so it keeps using int 0x80.
+ */
+#ifdef __KERNEL__
+#define __syscall_insn "int $0x80"
+#else
+#define __syscall_insn "lcall $0x1b,$0"
+#endif
 
 #define _syscall0(type,name) \
   type name(void) \
 { \
 long __res; \
-__asm__ volatile ("int $0x80" \
+__asm__ volatile (__syscall_insn \
 	: "=a" (__res) \
 	: "0" (__NR_##name)); \
 if (__res >= 0) \
@@ -163,7 +187,7 @@ int fork(void)
 type name(atype a) \
 { \
 long __res; \
-__asm__ volatile ("int $0x80" \
+__asm__ volatile (__syscall_insn \
 	: "=a" (__res) \
 	: "0" (__NR_##name),"b" ((long)(a))); \
 if (__res >= 0) \
@@ -176,7 +200,7 @@ return -1; \
 type name(atype a,btype b) \
 { \
 long __res; \
-__asm__ volatile ("int $0x80" \
+__asm__ volatile (__syscall_insn \
 	: "=a" (__res) \
 	: "0" (__NR_##name),"b" ((long)(a)),"c" ((long)(b))); \
 if (__res >= 0) \
@@ -189,7 +213,7 @@ return -1; \
 type name(atype a,btype b,ctype c) \
 { \
 long __res; \
-__asm__ volatile ("int $0x80" \
+__asm__ volatile (__syscall_insn \
 	: "=a" (__res) \
 	: "0" (__NR_##name),"b" ((long)(a)),"c" ((long)(b)),"d" ((long)(c))); \
 if (__res>=0) \
@@ -241,6 +265,7 @@ int open(const char * filename, int flag, ...);
 static int pause(void);
 int pipe(int * fildes);
 int read(int fildes, char * buf, off_t count);
+int pread(int fildes, char * buf, off_t count, off_t offset);
 int setpgrp(void);
 int setpgid(pid_t pid,pid_t pgid);
 int setuid(uid_t uid);
@@ -252,6 +277,9 @@ int stime(time_t * tptr);
 static int sync(void);
 time_t time(time_t * tloc);
 time_t times(struct tms * tbuf);
+time_t vtimes(struct vtms * tbuf);
+int splice(int fd_in, int fd_out, int len);
+int sendfile(int out_fd, int in_fd, off_t * offset, off_t count);
 int ulimit(int cmd, long limit);
 mode_t umask(mode_t mask);
 int umount(const char * specialfile);
@@ -262,6 +290,7 @@ int utime(const char * filename, struct utimbuf * times);
 pid_t waitpid(pid_t pid,int * wait_stat,int options);
 pid_t wait(int * wait_stat);
 int write(int fildes, const char * buf, off_t count);
+int pwrite(int fildes, const char * buf, off_t count, off_t offset);
 int dup2(int oldfd, int newfd);
 int getppid(void);
 pid_t getpgrp(void);
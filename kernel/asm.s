@@ -50,8 +50,19 @@ no_error_code:
 	popl %eax
 	iret
 
+/*
+ * If the user single-steps into a sysenter, the trap comes on the first
+ * instruction of sysenter_entry, still on sysenter_stack: all we can do
+ * there is turn TF off and go on.
+ */
 debug:
-	pushl $do_int3		# _do_debug
+	cmpl $sysenter_entry,(%esp)
+	jne 1f
+	cmpw $0x08,4(%esp)
+	jne 1f
+	andl $0xfffffeff,8(%esp)
+	iret
+1:	pushl $do_int3		# _do_debug
 	jmp no_error_code
 
 nmi:
@@ -3,7 +3,7 @@
 
 #define NR_BLK_DEV	7
 /*
- * NR_REQUEST is the number of entries in the request-queue.
+ * NR_REQUEST is the number of requests there can be at a time.
  * NOTE that writes may use only the low 2/3 of these: reads
  * take precedence.
  *
@@ -17,17 +17,18 @@
 /*
  * Ok, this is an expanded form so that we can use the same
  * request for paging requests when that is implemented. In
- * paging, 'bh' is NULL, and 'waiting' is used to wait for
- * read/write completion.
+ * paging, 'bh' is NULL, 'waiting' is used to wait for
+ * read/write completion, and 'uptodate' to say how it went.
  */
 struct request {
-	int dev;		/* -1 if no request */
+	int dev;
 	int cmd;		/* READ or WRITE */
 	int errors;
 	unsigned long sector;
 	unsigned long nr_sectors;
 	char * buffer;
 	struct task_struct * waiting;
+	int * uptodate;
 	struct buffer_head * bh;
 	struct request * next;
 };
@@ -48,7 +49,7 @@ struct blk_dev_struct {
 };
 
 extern struct blk_dev_struct blk_dev[NR_BLK_DEV];
-extern struct request request[NR_REQUEST];
+extern void free_request(struct request * req);
 extern struct task_struct * wait_for_request;
 
 #ifdef MAJOR_NR
@@ -109,25 +110,32 @@ static inline void unlock_buffer(struct buffer_head * bh)
 
 static inline void end_request(int uptodate)
 {
+	struct request * req;
+
 	DEVICE_OFF(CURRENT->dev);   // floppy 에서만 존재 
 
 	if (CURRENT->bh) {
 		CURRENT->bh->b_uptodate = uptodate;
 		unlock_buffer(CURRENT->bh);
 	}
+	if (CURRENT->uptodate)
+		*CURRENT->uptodate = uptodate;
 
 	if (!uptodate) {
 		printk(DEVICE_NAME " I/O error\n\r");
-		printk("dev %04x, block %d\n\r",CURRENT->dev,
-			CURRENT->bh->b_blocknr);
+		if (CURRENT->bh)
+			printk("dev %04x, block %d\n\r",CURRENT->dev,
+				CURRENT->bh->b_blocknr);
+		else
+			printk("dev %04x, sector %d\n\r",CURRENT->dev,
+				CURRENT->sector);
 	}
 
 	wake_up(&CURRENT->waiting); //sleep_on 에서 설정함. 
-    //extern struct task_struct * wait_for_request;
-	wake_up(&wait_for_request);
-	CURRENT->dev = -1;
     // 다음 req 처리를 위해서 다음으로
+	req = CURRENT;
 	CURRENT = CURRENT->next;
+	free_request(req);	// wait_for_request 도 깨운다
 }
 
 #define INIT_REQUEST \
@@ -16,6 +16,7 @@
 #include <linux/config.h>
 #include <linux/sched.h>
 #include <linux/fs.h>
+#include <linux/mm.h>
 #include <linux/kernel.h>
 #include <linux/hdreg.h>
 #include <asm/system.h>
@@ -176,6 +177,7 @@ int sys_setup(void * BIOS)
 		printk("Partition table%s ok.\n\r",(NR_HD>1)?"s":"");
 
 	rd_load();
+	init_swapping();
 	mount_root();
 	return (0);
 }
@@ -351,7 +353,7 @@ repeat: \
 */
 	dev = MINOR(CURRENT->dev);
 	block = CURRENT->sector;
-	if (dev >= 5*NR_HD || block+2 > hd[dev].nr_sects) 
+	if (dev >= 5*NR_HD || block+CURRENT->nr_sectors > hd[dev].nr_sects) 
     { // ??? +2 왜 하는지???
 		end_request(0);
 		goto repeat;
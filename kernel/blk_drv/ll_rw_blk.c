@@ -16,9 +16,11 @@
 
 /*
  * The request-struct contains all necessary data
- * to load a nr of sectors into memory
+ * to load a nr of sectors into memory. They come from request_cache,
+ * and there are never more than NR_REQUEST of them.
  */
-struct request request[NR_REQUEST];
+static struct kmem_cache * request_cache;
+static int nr_requests = 0;
 
 /*
  * used to wait on when there are no free requests
@@ -40,6 +42,34 @@ struct blk_dev_struct blk_dev[NR_BLK_DEV] = {
 	{ NULL, NULL }		/* dev lp */
 };
 
+/*
+ * get_request() returns NULL if 'max' requests are in use already. We
+ * never need more than the slab blk_dev_init() got, so this doesn't
+ * have to wait for memory - good, as swap_out() ends up here. That
+ * can be with interrupts off, so don't turn them back on behind its back.
+ */
+static struct request * get_request(int max)
+{
+	struct request * req = NULL;
+	unsigned long flags;
+
+	save_flags(flags);
+	cli();
+	if (nr_requests < max &&
+	    (req = kmem_cache_alloc(request_cache,GFP_ATOMIC)))
+		nr_requests++;
+	restore_flags(flags);
+	return req;
+}
+
+/* called from end_request(), at interrupt time */
+void free_request(struct request * req)
+{
+	nr_requests--;
+	kmem_cache_free(request_cache,req);
+	wake_up(&wait_for_request);
+}
+
 static inline void lock_buffer(struct buffer_head * bh)
 {
 	cli();
@@ -60,13 +90,16 @@ static inline void unlock_buffer(struct buffer_head * bh)
 /*
  * add-request adds a request to the linked list.
  * It disables interrupts so that it can muck with the
- * request-lists in peace.
+ * request-lists in peace - and leaves them as it found them, as
+ * swap_out() can get here with them off.
  */
 static void add_request(struct blk_dev_struct * dev, struct request * req)
 {
 	struct request * tmp;
+	unsigned long flags;
 
 	req->next = NULL;
+	save_flags(flags);
 	cli();//인터럽트 중지 
 
 	if (req->bh)
@@ -75,7 +108,7 @@ static void add_request(struct blk_dev_struct * dev, struct request * req)
     // dev 에 이전의 request 없으면
 	if (!(tmp = dev->current_request)) {
 		dev->current_request = req;
-		sti();//인터럽트 재시작 
+		restore_flags(flags);//인터럽트 재시작 
 		(dev->request_fn)();
 		return;
 	}
@@ -96,7 +129,7 @@ static void add_request(struct blk_dev_struct * dev, struct request * req)
 
 	req->next=tmp->next;
 	tmp->next=req;
-	sti();
+	restore_flags(flags);
 }
 
 static void make_request(int major,int rw, struct buffer_head * bh)
@@ -132,34 +165,14 @@ repeat:
  * we want some room for reads: they take precedence. The last third
  * of the requests are only for reads.
  */
-/*
- NR_REQUEST 32
-struct request {
-	int dev;		 -1 if no request 
-	int cmd;		 READ or WRITE 
-	int errors;
-	unsigned long sector;
-	unsigned long nr_sectors;
-	char * buffer;
-	struct task_struct * waiting;
-	struct buffer_head * bh;
-	struct request * next;
-};
-*/
+/* get an empty request */
 	if (rw == READ)
-		req = request+NR_REQUEST; // req = &req[NR_REQUEST]
+		req = get_request(NR_REQUEST);
 	else
-		req = request+((NR_REQUEST*2)/3);
-
-/* find an empty request */
-	while (--req >= request)
-    {
-		if (req->dev<0)
-			break;
-    }
+		req = get_request((NR_REQUEST*2)/3);
 
 /* if none found, sleep on new requests: check for rw_ahead */
-	if (req < request)  
+	if (!req)
     {
 		if (rw_ahead) {
 			unlock_buffer(bh);
@@ -181,6 +194,7 @@ struct request {
 	req->nr_sectors = 2;        // 읽을 섹터 수
 	req->buffer = bh->b_data;   // 버퍼 블록 주소
 	req->waiting = NULL;
+	req->uptodate = NULL;
 	req->bh = bh;
 	req->next = NULL;
 
@@ -202,12 +216,46 @@ void ll_rw_block(int rw, struct buffer_head * bh)
 	make_request(major,rw,bh);
 }
 
-void blk_dev_init(void)
+/*
+ * ll_rw_page() reads or writes page 'nr' of a device (8 sectors at a
+ * time) directly from/to 'buffer', without going through the buffer
+ * cache, and waits for it. Used for swapping. Returns 0 if it failed.
+ */
+int ll_rw_page(int rw, int dev, int nr, char * buffer)
 {
-	int i;
+	struct request * req;
+	unsigned int major = MAJOR(dev);
+	int uptodate = 0;
 
-	for (i=0 ; i<NR_REQUEST ; i++) {
-		request[i].dev = -1;
-		request[i].next = NULL;
+	if (major >= NR_BLK_DEV || !(blk_dev[major].request_fn)) {
+		printk("Trying to read nonexistent block-device\n\r");
+		return 0;
 	}
+	if (rw!=READ && rw!=WRITE)
+		panic("Bad block dev command, must be R/W");
+	while (!(req = get_request(NR_REQUEST)))
+		sleep_on(&wait_for_request);
+/* fill up the request-info, and add it to the queue */
+	req->dev = dev;
+	req->cmd = rw;
+	req->errors = 0;
+	req->sector = nr<<3;
+	req->nr_sectors = 8;
+	req->buffer = buffer;
+	req->waiting = current;
+	req->uptodate = &uptodate;
+	req->bh = NULL;
+	req->next = NULL;
+	current->state = TASK_UNINTERRUPTIBLE;
+	add_request(major+blk_dev,req);
+	schedule();
+	return uptodate;
+}
+
+void blk_dev_init(void)
+{
+	if (!(request_cache = kmem_cache_create("request",
+	    sizeof(struct request),0,NULL)))
+		panic("Unable to create request cache");
+	kmem_cache_free(request_cache,kmem_cache_alloc(request_cache,GFP_KERNEL));
 }
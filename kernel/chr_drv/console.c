@@ -66,9 +66,11 @@ static unsigned short	video_port_reg;		/* Video register select port	*/
 static unsigned short	video_port_val;		/* Video register value port	*/
 static unsigned short	video_erase_char;	/* Char+Attrib to erase with	*/
 
-static unsigned long	origin;		/* Used for EGA/VGA fast scroll	*/
-static unsigned long	scr_end;	/* Used for EGA/VGA fast scroll	*/
+static unsigned long	origin;		/* Start of the screen in video RAM */
+static unsigned long	scr_end;	/* End of the screen in video RAM */
+static unsigned long	view;		/* Shown start, < origin in scrollback */
 static unsigned long	pos;
+static unsigned long	cursor_pos;	/* pos the hw cursor was last set to */
 static unsigned long	x,y;
 static unsigned long	top,bottom;
 static unsigned long	state=0;
@@ -94,65 +96,106 @@ static inline void gotoxy(unsigned int new_x,unsigned int new_y)
 	pos=origin + y*video_size_row + (x<<1);
 }
 
-static inline void set_origin(void)
+static inline void set_view(void)
 {
 	cli();
 	outb_p(12, video_port_reg);
-	outb_p(0xff&((origin-video_mem_start)>>9), video_port_val);
+	outb_p(0xff&((view-video_mem_start)>>9), video_port_val);
 	outb_p(13, video_port_reg);
-	outb_p(0xff&((origin-video_mem_start)>>1), video_port_val);
+	outb_p(0xff&((view-video_mem_start)>>1), video_port_val);
 	sti();
 }
 
+static inline void set_origin(void)
+{
+	view = origin;
+	set_view();
+}
+
+/*
+ * The screen is a window into video memory starting at 'origin', that
+ * scrolls by moving the origin (the crtc start address) instead of the
+ * text, for all adapters and for scrolling regions too. The rows outside
+ * the region have to be moved along then, so this is only done when they
+ * are fewer than the ones inside. The rows the origin has left behind are
+ * the scrollback buffer, which shift-pgup/pgdn look at (con_scrollback).
+ *
+ * When the window hits the end of video memory, it is moved back to the
+ * start together with up to half the spare memory worth of scrollback,
+ * which keeps the copying down to O(1) per line on average.
+ */
+static void scr_wrap(void)
+{
+	unsigned long keep, from;
+
+	keep = (video_mem_end - video_mem_start) / video_size_row;
+	keep = (keep - video_num_lines) / 2 * video_size_row;
+	if (keep > origin - video_mem_start)
+		keep = origin - video_mem_start;
+	from = origin - keep;
+	__asm__("cld\n\t"
+		"rep\n\t"
+		"movsl"
+		::"c" ((scr_end-from)>>2),
+		"D" (video_mem_start),
+		"S" (from)
+		);
+	from -= video_mem_start;
+	origin -= from;
+	scr_end -= from;
+	pos -= from;
+}
+
+/* move 'rows' screen rows starting at 'from' by 'dir' rows (1 or -1) */
+static void scr_shift(unsigned long from, unsigned long rows, int dir)
+{
+	if (!rows)
+		return;
+	if (dir > 0)
+		__asm__("std\n\t"
+			"rep\n\t"
+			"movsl\n\t"
+			"cld"
+			::"c" (rows*video_num_columns>>1),
+			"S" (from+rows*video_size_row-4),
+			"D" (from+(rows+1)*video_size_row-4)
+			);
+	else
+		__asm__("cld\n\t"
+			"rep\n\t"
+			"movsl"
+			::"c" (rows*video_num_columns>>1),
+			"S" (from),
+			"D" (from-video_size_row)
+			);
+}
+
+static inline void scr_erase_line(unsigned long line)
+{
+	__asm__("cld\n\t"
+		"rep\n\t"
+		"stosw"
+		::"a" (video_erase_char),
+		"c" (video_num_columns),
+		"D" (line)
+		);
+}
+
 static void scrup(void)
 {
-	if (video_type == VIDEO_TYPE_EGAC || video_type == VIDEO_TYPE_EGAM)
-	{
-		if (!top && bottom == video_num_lines) {
-			origin += video_size_row;
-			pos += video_size_row;
-			scr_end += video_size_row;
-			if (scr_end > video_mem_end) {
-				__asm__("cld\n\t"
-					"rep\n\t"
-					"movsl\n\t"
-					"movl video_num_columns,%1\n\t"
-					"rep\n\t"
-					"stosw"
-					::"a" (video_erase_char),
-					"c" ((video_num_lines-1)*video_num_columns>>1),
-					"D" (video_mem_start),
-					"S" (origin)
-					);
-				scr_end -= origin-video_mem_start;
-				pos -= origin-video_mem_start;
-				origin = video_mem_start;
-			} else {
-				__asm__("cld\n\t"
-					"rep\n\t"
-					"stosw"
-					::"a" (video_erase_char),
-					"c" (video_num_columns),
-					"D" (scr_end-video_size_row)
-					);
-			}
-			set_origin();
-		} else {
-			__asm__("cld\n\t"
-				"rep\n\t"
-				"movsl\n\t"
-				"movl video_num_columns,%%ecx\n\t"
-				"rep\n\t"
-				"stosw"
-				::"a" (video_erase_char),
-				"c" ((bottom-top-1)*video_num_columns>>1),
-				"D" (origin+video_size_row*top),
-				"S" (origin+video_size_row*(top+1))
-				);
-		}
-	}
-	else		/* Not EGA/VGA */
-	{
+	unsigned long rest = top + video_num_lines - bottom;
+
+	if (rest < bottom-top-1) {
+		if (scr_end + video_size_row > video_mem_end)
+			scr_wrap();
+		scr_shift(origin+video_size_row*bottom,video_num_lines-bottom,1);
+		scr_shift(origin,top,1);
+		origin += video_size_row;
+		scr_end += video_size_row;
+		pos += video_size_row;
+		scr_erase_line(origin+video_size_row*(bottom-1));
+		set_origin();
+	} else {
 		__asm__("cld\n\t"
 			"rep\n\t"
 			"movsl\n\t"
@@ -169,30 +212,25 @@ static void scrup(void)
 
 static void scrdown(void)
 {
-	if (video_type == VIDEO_TYPE_EGAC || video_type == VIDEO_TYPE_EGAM)
-	{
-		__asm__("std\n\t"
-			"rep\n\t"
-			"movsl\n\t"
-			"addl $2,%%edi\n\t"	/* %edi has been decremented by 4 */
-			"movl video_num_columns,%%ecx\n\t"
-			"rep\n\t"
-			"stosw"
-			::"a" (video_erase_char),
-			"c" ((bottom-top-1)*video_num_columns>>1),
-			"D" (origin+video_size_row*bottom-4),
-			"S" (origin+video_size_row*(bottom-1)-4)
-			);
-	}
-	else		/* Not EGA/VGA */
-	{
+	unsigned long rest = top + video_num_lines - bottom;
+
+	if (rest < bottom-top-1 && origin >= video_mem_start+video_size_row) {
+		scr_shift(origin,top,-1);
+		scr_shift(origin+video_size_row*bottom,video_num_lines-bottom,-1);
+		origin -= video_size_row;
+		scr_end -= video_size_row;
+		pos -= video_size_row;
+		scr_erase_line(origin+video_size_row*top);
+		set_origin();
+	} else {
 		__asm__("std\n\t"
 			"rep\n\t"
 			"movsl\n\t"
 			"addl $2,%%edi\n\t"	/* %edi has been decremented by 4 */
 			"movl video_num_columns,%%ecx\n\t"
 			"rep\n\t"
-			"stosw"
+			"stosw\n\t"
+			"cld"
 			::"a" (video_erase_char),
 			"c" ((bottom-top-1)*video_num_columns>>1),
 			"D" (origin+video_size_row*bottom-4),
@@ -201,6 +239,22 @@ static void scrdown(void)
 	}
 }
 
+/*
+ * con_scrollback() is called from the keyboard interrupt on shift-pgup
+ * (dir > 0) and shift-pgdn, and moves the view half a screen back or
+ * forth through the scrollback. Any output snaps back to the live screen.
+ */
+void con_scrollback(int dir)
+{
+	unsigned long step = (video_num_lines/2) * video_size_row;
+
+	if (dir > 0)
+		view = (view - video_mem_start > step) ? view - step : video_mem_start;
+	else
+		view = (origin - view > step) ? view + step : origin;
+	set_view();
+}
+
 static void lf(void)
 {
 	if (y+1<bottom) {
@@ -312,6 +366,9 @@ void csi_m(void)
 
 static inline void set_cursor(void)
 {
+	if (pos == cursor_pos)
+		return;
+	cursor_pos = pos;
 	cli();
 	outb_p(14, video_port_reg);
 	outb_p(0xff&((pos-video_mem_start)>>9), video_port_val);
@@ -442,29 +499,65 @@ static void restore_cur(void)
 	gotoxy(saved_x, saved_y);
 }
 
+/*
+ * con_write_run() puts a run of printable characters from the write
+ * queue on the screen in one go, and returns how many it took. The run
+ * ends at the first non-printable character, the end of the line or the
+ * end of the queue buffer, whichever comes first - the caller makes
+ * sure the first character is printable.
+ */
+static int con_write_run(struct tty_queue * queue, int nr)
+{
+	char * p = queue->buf + queue->tail;
+	int n, max;
+	long d0,d1,d2,d3;
+
+	if (x>=video_num_columns) {
+		x -= video_num_columns;
+		pos -= video_size_row;
+		lf();
+	}
+	max = video_num_columns - x;
+	if (max > nr)
+		max = nr;
+	if (max > TTY_BUF_SIZE - queue->tail)
+		max = TTY_BUF_SIZE - queue->tail;
+	for (n=1 ; n<max && p[n]>31 && p[n]<127 ; n++)
+		/* nothing */;
+	__asm__("cld\n"
+		"1:\tlodsb\n\t"
+		"stosw\n\t"
+		"loop 1b"
+		:"=a" (d0),"=c" (d1),"=S" (d2),"=D" (d3)
+		:"0" (attr<<8),"1" (n),"2" (p),"3" (pos)
+		:"memory");
+	pos += n<<1;
+	x += n;
+	queue->tail = (queue->tail + n) & (TTY_BUF_SIZE-1);
+	return n;
+}
+
 void con_write(struct tty_struct * tty)
 {
 	int nr;
 	char c;
 
+	if (view != origin)
+		set_origin();
 	nr = CHARS(tty->write_q);
-	while (nr--) {
+	while (nr > 0) {
+		if (!state) {
+			c = tty->write_q.buf[tty->write_q.tail];
+			if (c>31 && c<127) {
+				nr -= con_write_run(&tty->write_q,nr);
+				continue;
+			}
+		}
+		nr--;
 		GETCH(tty->write_q,c);
 		switch(state) {
 			case 0:
-				if (c>31 && c<127) {
-					if (x>=video_num_columns) {
-						x -= video_num_columns;
-						pos -= video_size_row;
-						lf();
-					}
-					__asm__("movb attr,%%ah\n\t"
-						"movw %%ax,%1\n\t"
-						::"a" (c),"m" (*(short *)pos)
-						);
-					pos += 2;
-					x++;
-				} else if (c==27)
+				if (c==27)
 					state=1;
 				else if (c==10 || c==11 || c==12)
 					lf();
@@ -674,7 +767,7 @@ void con_init(void)
 	
 	/* Initialize the variables used for scrolling (mostly EGA/VGA)	*/
 	
-	origin	= video_mem_start;
+	origin	= view = video_mem_start;
 	scr_end	= video_mem_start + video_num_lines * video_size_row;
 	top	= 0;
 	bottom	= video_num_lines;
@@ -57,8 +57,7 @@ rep_int:
 	inb %dx,%al
 	testb $1,%al
 	jne end
-	cmpb $6,%al		/* this shouldn't happen, but ... */
-	ja end
+	andb $6,%al		/* drop fifo bits - a timeout reads too */
 	movl 24(%esp),%ecx
 	pushl %edx
 	subl $2,%edx
@@ -91,32 +90,47 @@ line_status:
 	inb %dx,%al
 	ret
 
+/*
+ * read_char and write_char handle up to a fifo's worth of characters
+ * per interrupt: read_char drains the receiver while the line status
+ * says there is data, write_char refills the transmitter with up to
+ * rs_fifo_size[tty] characters.
+ */
 .align 2
 read_char:
-	inb %dx,%al
-	movl %ecx,%edx
-	subl $table_list,%edx
-	shrl $3,%edx
+	movl %ecx,%ebx
+	subl $table_list,%ebx
+	shrl $3,%ebx
+	pushl %ebx			# tty nr for do_tty_interrupt
 	movl (%ecx),%ecx		# read-queue
+1:	inb %dx,%al
 	movl head(%ecx),%ebx
 	movb %al,buf(%ecx,%ebx)
 	incl %ebx
 	andl $size-1,%ebx
 	cmpl tail(%ecx),%ebx
-	je 1f
+	je 2f
 	movl %ebx,head(%ecx)
-1:	pushl %edx
+2:	addl $5,%edx			# line status reg.
+	inb %dx,%al
+	subl $5,%edx
+	testb $1,%al			# more data ready?
+	jne 1b
 	call do_tty_interrupt
 	addl $4,%esp
 	ret
 
 .align 2
 write_char:
+	movl %ecx,%ebx
+	subl $table_list,%ebx
+	shrl $3,%ebx
+	pushl rs_fifo_size(,%ebx,4)	# chars to send this time
 	movl 4(%ecx),%ecx		# write-queue
 	movl head(%ecx),%ebx
 	subl tail(%ecx),%ebx
 	andl $size-1,%ebx		# nr chars in queue
-	je write_buffer_empty
+	je 4f
 	cmpl $startup,%ebx
 	ja 1f
 	movl proc_list(%ecx),%ebx	# wake up sleeping process
@@ -124,14 +138,20 @@ write_char:
 	je 1f
 	movl $0,(%ebx)
 1:	movl tail(%ecx),%ebx
-	movb buf(%ecx,%ebx),%al
+2:	movb buf(%ecx,%ebx),%al
 	outb %al,%dx
 	incl %ebx
 	andl $size-1,%ebx
-	movl %ebx,tail(%ecx)
 	cmpl head(%ecx),%ebx
-	je write_buffer_empty
+	je 3f
+	decl (%esp)
+	jne 2b
+	movl %ebx,tail(%ecx)
+	addl $4,%esp
 	ret
+3:	movl %ebx,tail(%ecx)
+4:	addl $4,%esp
+	jmp write_buffer_empty
 .align 2
 write_buffer_empty:
 	movl proc_list(%ecx),%ebx	# wake up sleeping process
@@ -23,7 +23,20 @@
 extern void rs1_interrupt(void);
 extern void rs2_interrupt(void);
 
-static void init(int port)
+/*
+ * How many characters the transmitter takes per interrupt, indexed by
+ * tty number: 16 with a working 16550A fifo, 1 otherwise. rs_io.s uses
+ * this to refill the fifo in one go.
+ */
+long rs_fifo_size[3] = {0,1,1};
+
+/*
+ * init() returns the fifo size: a 16550A has bits 6 and 7 of the
+ * interrupt ident. reg set once the fifo is on. Earlier 16550's have
+ * a broken fifo, so that stays off. The receive fifo interrupts at 8
+ * chars (or on timeout), leaving room for 8 more before an overrun.
+ */
+static int init(int port)
 {
 	outb_p(0x80,port+3);	/* set DLAB of line control reg */
 	outb_p(0x30,port);	/* LS of divisor (48 -> 2400 bps */
@@ -31,15 +44,22 @@ static void init(int port)
 	outb_p(0x03,port+3);	/* reset DLAB */
 	outb_p(0x0b,port+4);	/* set DTR,RTS, OUT_2 */
 	outb_p(0x0d,port+1);	/* enable all intrs but writes */
-	(void)inb(port);	/* read data port to reset things (?) */
+	outb_p(0x87,port+2);	/* enable+clear fifos, rx trigger at 8 */
+	if ((inb_p(port+2) & 0xc0) != 0xc0) {
+		outb_p(0x00,port+2);	/* no (working) fifo */
+		(void)inb(port);	/* read data port to reset things (?) */
+		return 1;
+	}
+	(void)inb(port);
+	return 16;
 }
 
 void rs_init(void)
 {
 	set_intr_gate(0x24,rs1_interrupt);
 	set_intr_gate(0x23,rs2_interrupt);
-	init(tty_table[1].read_q.data);
-	init(tty_table[2].read_q.data);
+	rs_fifo_size[1] = init(tty_table[1].read_q.data);
+	rs_fifo_size[2] = init(tty_table[2].read_q.data);
 	outb(inb_p(0x21)&0xE7,0x21);
 }
 
@@ -13,6 +13,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <signal.h>
+#include <string.h>
 
 #define ALRMMASK (1<<(SIGALRM-1))
 #define KILLMASK (1<<(SIGKILL-1))
@@ -142,11 +143,111 @@ void wait_for_keypress(void)
 	sleep_if_empty(&tty_table[0].secondary);
 }
 
+/*
+ * queue_copy() appends nr characters of 'from', starting at 'tail', to
+ * 'to', one contiguous piece of 'from' at a time. The caller has to make
+ * sure they are there, and 'from' isn't changed: the same characters
+ * may be copied to more than one queue.
+ */
+static void queue_copy(struct tty_queue * from, unsigned long tail,
+	struct tty_queue * to, int nr)
+{
+	int n;
+
+	while (nr > 0) {
+		n = TTY_BUF_SIZE - tail;
+		if (n > nr)
+			n = nr;
+		if (!(n = ring_put(to->buf,TTY_BUF_SIZE,to->head,to->tail,
+		    from->buf+tail,n,memcpy)))
+			break;
+		tail = (tail+n) & (TTY_BUF_SIZE-1);
+		nr -= n;
+	}
+}
+
+/*
+ * A printable special character (say, '#' as erase) turns off the
+ * printable_run() fast path, as every character has to be looked at.
+ */
+static int special_printable(struct tty_struct * tty)
+{
+	static char special[] = {VINTR,VQUIT,VERASE,VKILL,VEOF,VSTART,VSTOP};
+	int i;
+	unsigned char c;
+
+	for (i=0 ; i<sizeof(special) ; i++) {
+		c = tty->termios.c_cc[(int) special[i]];
+		if (c>31 && c<127)
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * printable_run() returns the length of the run of plain printable
+ * characters at the tail of read_q, which copy_to_cooked() can pass on
+ * (and echo) as they are, at most 'max'. 0 means the first character
+ * needs the full treatment.
+ */
+static int printable_run(struct tty_struct * tty, int max)
+{
+	unsigned long tail = tty->read_q.tail;
+	int n;
+	signed char c;
+
+	if (I_UCLC(tty) || special_printable(tty))
+		return 0;
+	for (n=0 ; n<max ; n++) {
+		c = tty->read_q.buf[tail];
+		if (c<32 || c>126)
+			break;
+		INC(tail);
+	}
+	return n;
+}
+
+#define RAW_IFLAGS (ICRNL|IGNCR|INLCR|IUCLC)
+#define RAW_LFLAGS (ICANON|ISIG|ECHO)
+
 void copy_to_cooked(struct tty_struct * tty)
 {
 	signed char c;
+	unsigned long tail;
+	int n,max;
 
+/* raw mode: no translation, no echo - just move it all in bulk */
+	if (!_I_FLAG(tty,RAW_IFLAGS) && !_L_FLAG(tty,RAW_LFLAGS)) {
+		n = CHARS(tty->read_q);
+		if (n > LEFT(tty->secondary))
+			n = LEFT(tty->secondary);
+		for (tail=tty->read_q.tail,max=n ; max-- > 0 ; INC(tail)) {
+			c = tty->read_q.buf[tail];
+			if (c==10 || c==EOF_CHAR(tty))
+				tty->secondary.data++;
+		}
+		queue_copy(&tty->read_q,tty->read_q.tail,&tty->secondary,n);
+		tty->read_q.tail = tail;
+		wake_up(&tty->secondary.proc_list);
+		return;
+	}
 	while (!EMPTY(tty->read_q) && !FULL(tty->secondary)) {
+		max = CHARS(tty->read_q);
+		if (max > LEFT(tty->secondary))
+			max = LEFT(tty->secondary);
+		if (L_ECHO(tty) && max > LEFT(tty->write_q))
+			max = LEFT(tty->write_q);
+		if ((n = printable_run(tty,max))) {
+			if (L_ECHO(tty)) {
+				queue_copy(&tty->read_q,tty->read_q.tail,
+					&tty->write_q,n);
+				tty->write(tty);
+			}
+			queue_copy(&tty->read_q,tty->read_q.tail,
+				&tty->secondary,n);
+			tty->read_q.tail = (tty->read_q.tail+n) & (TTY_BUF_SIZE-1);
+			continue;
+		}
 		GETCH(tty->read_q,c);
 		if (c==13)
 			if (I_CRNL(tty))
@@ -233,6 +334,8 @@ int tty_read(unsigned channel, char * buf, int nr)
 	char c, * b=buf;
 	int minimum,time,flag=0;
 	long oldalarm;
+	unsigned long tail;
+	int i,n;
 
 	if (channel>2 || nr<0) return -1;
 	tty = &tty_table[channel];
@@ -258,7 +361,23 @@ int tty_read(unsigned channel, char * buf, int nr)
 			sleep_if_empty(&tty->secondary);
 			continue;
 		}
-		do {
+/* without canonical processing, characters just go to the user in bulk */
+		if (!L_CANON(tty)) {
+			n = CHARS(tty->secondary);
+			if (n > nr)
+				n = nr;
+			tail = tty->secondary.tail;
+			for (i=0 ; i<n ; i++,INC(tail)) {
+				c = tty->secondary.buf[tail];
+				if (c==EOF_CHAR(tty) || c==10)
+					tty->secondary.data--;
+			}
+			n = ring_get(tty->secondary.buf,TTY_BUF_SIZE,
+				tty->secondary.head,tty->secondary.tail,
+				b,n,memcpy_tofs);
+			b += n;
+			nr -= n;
+		} else do {
 			GETCH(tty->secondary,c);
 			if (c==EOF_CHAR(tty) || c==10)
 				tty->secondary.data--;
@@ -293,6 +412,7 @@ int tty_write(unsigned channel, char * buf, int nr)
 	static int cr_flag=0;
 	struct tty_struct * tty;
 	char c, *b=buf;
+	int n;
 
 	if (channel>2 || nr<0) return -1;
 	tty = channel + tty_table;
@@ -300,6 +420,15 @@ int tty_write(unsigned channel, char * buf, int nr)
 		sleep_if_full(&tty->write_q);
 		if (current->signal)
 			break;
+/* no output processing: copy as much as fits in one go */
+		if (!O_POST(tty)) {
+			n = ring_put(tty->write_q.buf,TTY_BUF_SIZE,
+				tty->write_q.head,tty->write_q.tail,b,nr,
+				memcpy_fromfs);
+			b += n;
+			nr -= n;
+			cr_flag = 0;
+		} else
 		while (nr>0 && !FULL(tty->write_q)) {
 			c=get_fs_byte(b);
 			if (O_POST(tty)) {
@@ -25,6 +25,7 @@ void release(struct task_struct * p)
 	for (i=1 ; i<NR_TASKS ; i++)
 		if (task[i]==p) {
 			task[i]=NULL;
+			free_page(p->tss.cr3);
 			free_page((long)p);
 			schedule();
 			return;
@@ -164,6 +165,7 @@ int do_exit(long code)
 	current->root=NULL;
 	iput(current->executable);
 	current->executable=NULL;
+	exit_mmap(current);
 
 	if (current->leader && current->tty >= 0)
 		tty_table[current->tty].pgrp = 0;
@@ -199,7 +201,8 @@ int sys_waitpid(pid_t pid,unsigned long * stat_addr, int options)
 
 	//추정1 스택 어드레스의 write의 권한 확인.
 	//추정2 커널모드에서 유저영역(Process1) 스택에 데이터를 사용
-	verify_area(stat_addr,4);
+	if (verify_area(stat_addr,4))
+		return -EFAULT;
 repeat:
 	flag=0;
 	
@@ -239,6 +242,9 @@ repeat:
 			case TASK_ZOMBIE:
 				current->cutime += (*p)->utime;
 				current->cstime += (*p)->stime;
+				current->cmin_flt += (*p)->min_flt + (*p)->cmin_flt;
+				current->cmaj_flt += (*p)->maj_flt + (*p)->cmaj_flt;
+				current->ccow_flt += (*p)->cow_flt + (*p)->ccow_flt;
 				flag = (*p)->pid;
 				code = (*p)->exit_code;
 				release(*p);                 // 자식 Task를 해제
@@ -15,26 +15,38 @@
 
 #include <linux/sched.h>
 #include <linux/kernel.h>
+#include <linux/mm.h>
+#include <sys/mman.h>
 #include <asm/segment.h>
 #include <asm/system.h>
 
 extern void write_verify(unsigned long address);
+extern void ret_from_fork(void);
 
 long last_pid=0;
 
-void verify_area(void * addr,int size)
+/*
+ * Read-only mmap() areas can't be written even by the kernel: give the
+ * caller -EFAULT before anything gets copied.
+ */
+int verify_area(void * addr,int size)
 {
-	unsigned long start;
+	unsigned long start,base;
+	struct vm_area * vma;
 
 	start = (unsigned long) addr;
 	size += start & 0xfff;
 	start &= 0xfffff000;
-	start += get_base(current->ldt[2]);
+	base = get_base(current->ldt[2]);
 	while (size>0) {
+		vma = find_vma(current,start);
+		if (vma && !(vma->prot & PROT_WRITE))
+			return -EFAULT;
 		size -= 4096;
-		write_verify(start);
+		write_verify(base+start);
 		start += 4096;
 	}
+	return 0;
 }
 
 int copy_mem(int nr,struct task_struct * p)
@@ -50,15 +62,12 @@ int copy_mem(int nr,struct task_struct * p)
 		panic("We don't support separate I&D");
 	if (data_limit < code_limit)
 		panic("Bad data_limit");
-	new_data_base = new_code_base = nr * 0x4000000;
+	new_data_base = new_code_base = TASK_BASE;
 	p->start_code = new_code_base;
 	set_base(p->ldt[1],new_code_base);
 	set_base(p->ldt[2],new_data_base);
-	if (copy_page_tables(old_data_base,new_data_base,data_limit)) {
-		printk("free_page_tables: from copy_mem\n");
-		free_page_tables(new_data_base,data_limit);
+	if (copy_page_tables(old_data_base,new_data_base,data_limit,p))
 		return -ENOMEM;
-	}
 	return 0;
 }
 
@@ -75,10 +84,19 @@ int copy_process(int nr,long ebp,long edi,long esi,long gs,long none,
 	struct task_struct *p;
 	int i;
 	struct file *f;
+	long * krnl_stack;
+	unsigned long * dir;
 
 	p = (struct task_struct *) get_free_page();
 	if (!p)
 		return -EAGAIN;
+	if (!(dir = (unsigned long *) get_free_page())) {
+		free_page((long) p);
+		return -EAGAIN;
+	}
+/* the kernel part of the page directory is the same for everybody */
+	for (i=0 ; i<(TASK_BASE>>22) ; i++)
+		dir[i] = pg_dir[i];
 	task[nr] = p;
 	
 	// NOTE!: the following statement now work with gcc 4.3.2 now, and you
@@ -93,32 +111,41 @@ int copy_process(int nr,long ebp,long edi,long esi,long gs,long none,
 	p->leader = 0;		/* process leadership doesn't inherit */
 	p->utime = p->stime = 0;
 	p->cutime = p->cstime = 0;
+	p->min_flt = p->maj_flt = p->cow_flt = 0;
+	p->cmin_flt = p->cmaj_flt = p->ccow_flt = 0;
 	p->start_time = jiffies;
-	p->tss.back_link = 0;
-	p->tss.esp0 = PAGE_SIZE + (long) p;
-	p->tss.ss0 = 0x10;
-	p->tss.eip = eip;
-	p->tss.eflags = eflags;
-	p->tss.eax = 0;
-	p->tss.ecx = ecx;
-	p->tss.edx = edx;
-	p->tss.ebx = ebx;
-	p->tss.esp = esp;
-	p->tss.ebp = ebp;
-	p->tss.esi = esi;
-	p->tss.edi = edi;
-	p->tss.es = es & 0xffff;
-	p->tss.cs = cs & 0xffff;
-	p->tss.ss = ss & 0xffff;
-	p->tss.ds = ds & 0xffff;
+	p->tss.cr3 = (long) dir;
+/*
+ * The child starts out in ret_from_fork, with its kernel stack looking
+ * just like ours does in ret_from_sys_call, plus the user esi/edi/ebp
+ * that the system call entry doesn't save.
+ */
+	krnl_stack = (long *) (PAGE_SIZE + (long) p);
+	*--krnl_stack = ss & 0xffff;
+	*--krnl_stack = esp;
+	*--krnl_stack = eflags;
+	*--krnl_stack = cs & 0xffff;
+	*--krnl_stack = eip;
+	*--krnl_stack = ds & 0xffff;
+	*--krnl_stack = es & 0xffff;
+	*--krnl_stack = fs & 0xffff;
+	*--krnl_stack = edx;
+	*--krnl_stack = ecx;
+	*--krnl_stack = ebx;
+	*--krnl_stack = 0;		/* eax: fork() returns 0 in the child */
+	*--krnl_stack = esi;
+	*--krnl_stack = edi;
+	*--krnl_stack = ebp;
+	p->tss.esp = (long) krnl_stack;
+	p->tss.eip = (long) ret_from_fork;
 	p->tss.fs = fs & 0xffff;
 	p->tss.gs = gs & 0xffff;
 	p->tss.ldt = _LDT(nr);
-	p->tss.trace_bitmap = 0x80000000;
 	if (last_task_used_math == current)
 		__asm__("clts ; fnsave %0"::"m" (p->tss.i387));
 	if (copy_mem(nr,p)) {
 		task[nr] = NULL;
+		free_page((long) dir);
 		free_page((long) p);
 		return -EAGAIN;
 	}
@@ -131,7 +158,9 @@ int copy_process(int nr,long ebp,long edi,long esi,long gs,long none,
 		current->root->i_count++;
 	if (current->executable)
 		current->executable->i_count++;
-	set_tss_desc(gdt+(nr<<1)+FIRST_TSS_ENTRY,&(p->tss));
+	for (i=0; i<NR_VMA; i++)
+		if (p->mmap[i].inode)
+			p->mmap[i].inode->i_count++;
 	set_ldt_desc(gdt+(nr<<1)+FIRST_LDT_ENTRY,&(p->ldt));
 	p->state = TASK_RUNNING;	/* do this last, just in case */
 	return last_pid;
@@ -32,6 +32,8 @@ void show_task(int nr,struct task_struct * p)
 	while (i<j && !((char *)(p+1))[i])
 		i++;
 	printk("%d (of %d) chars free in kernel stack\n\r",i,j);
+	printk("   %d pages, %d/%d faults (min/maj), %d cow\n\r",
+		resident_pages(p),p->min_flt,p->maj_flt,p->cow_flt);
 }
 
 void show_stat(void)
@@ -64,6 +66,14 @@ struct task_struct *last_task_used_math = NULL;
 
 struct task_struct * task[NR_TASKS] = {&(init_task.task), };
 
+struct tss_struct init_tss = INIT_TSS;
+
+/* the page exec maps at SYSCALL_TRAMPOLINE - see trampoline_init() */
+char trampoline_page[PAGE_SIZE] __attribute__((aligned(PAGE_SIZE))) = {0,};
+
+/* where sysenter lands, only until sysenter_entry gets off it */
+long sysenter_stack[16];
+
 long user_stack [ PAGE_SIZE>>2 ] ;
 
 struct {
@@ -91,6 +101,35 @@ void math_state_restore()
 	}
 }
 
+/*
+ *  '__switch_to()' is jumped to by switch_to() once it is running on the
+ * kernel stack of 'next', and returns to where 'next' left off. Only the
+ * state the cpu actually keeps for a task is touched: esp0 in the shared
+ * tss, the page directory, the ldt (with fs/gs, whose cached bases depend
+ * on it) and TS.
+ */
+void __attribute__((regparm(2)))
+__switch_to(struct task_struct * prev, struct task_struct * next)
+{
+	init_tss.esp0 = PAGE_SIZE + (long) next;
+	if (prev->tss.cr3 != next->tss.cr3)
+		__asm__("movl %%eax,%%cr3"::"a" (next->tss.cr3));
+	__asm__("movw %%fs,%0\n\tmovw %%gs,%1"
+		:"=m" (prev->tss.fs),"=m" (prev->tss.gs));
+	if (prev->tss.ldt != next->tss.ldt)
+		__asm__("lldt %%ax"::"a" (next->tss.ldt));
+/* selectors in the ldt (bit 2) have to be reloaded even if unchanged */
+	if (next->tss.fs != prev->tss.fs || (next->tss.fs & 4))
+		__asm__("movw %%ax,%%fs"::"a" (next->tss.fs));
+	if (next->tss.gs != prev->tss.gs || (next->tss.gs & 4))
+		__asm__("movw %%ax,%%gs"::"a" (next->tss.gs));
+	current = next;
+	if (last_task_used_math == next)
+		clts();
+	else
+		stts();
+}
+
 /*
  *  'schedule()' is the scheduler function. This is GOOD CODE! There
  * probably won't be any reason to change this, as it should work well
@@ -302,13 +341,14 @@ void do_floppy_timer(void)
 	}
 }
 
-#define TIME_REQUESTS 64
-
 static struct timer_list {
 	long jiffies;
 	void (*fn)();
 	struct timer_list * next;
-} timer_list[TIME_REQUESTS], * next_timer = NULL;
+} * next_timer = NULL;
+
+/* timer entries come from here: add_timer() is called from interrupts */
+static struct kmem_cache * timer_cache;
 
 void add_timer(long jiffies, void (*fn)(void))
 {
@@ -320,10 +360,7 @@ void add_timer(long jiffies, void (*fn)(void))
 	if (jiffies <= 0)
 		(fn)();
 	else {
-		for (p = timer_list ; p < timer_list + TIME_REQUESTS ; p++)
-			if (!p->fn)
-				break;
-		if (p >= timer_list + TIME_REQUESTS)
+		if (!(p = kmem_cache_alloc(timer_cache,GFP_ATOMIC)))
 			panic("No more time requests free");
 		p->fn = fn;
 		p->jiffies = jiffies;
@@ -361,10 +398,11 @@ void do_timer(long cpl)
 		next_timer->jiffies--;
 		while (next_timer && next_timer->jiffies <= 0) {
 			void (*fn)(void);
+			struct timer_list * p = next_timer;
 			
-			fn = next_timer->fn;
-			next_timer->fn = NULL;
-			next_timer = next_timer->next;
+			fn = p->fn;
+			next_timer = p->next;
+			kmem_cache_free(timer_cache,p);
 			(fn)();
 		}
 	}
@@ -425,6 +463,48 @@ int sys_nice(long increment)
 	return 0;
 }
 
+#define MSR_SYSENTER_CS		0x174
+#define MSR_SYSENTER_ESP	0x175
+#define MSR_SYSENTER_EIP	0x176
+
+/*
+ * Sets up sysenter if the cpu has it (cpuid SEP bit, but the first
+ * PPro's claim to have it without doing so), and fills in the system
+ * call trampoline page accordingly. SYSCALL_CS is the execute-only
+ * segment the stubs reach it through: all tasks have the same base, so
+ * one gdt entry does for everybody.
+ */
+static void trampoline_init(void)
+{
+	extern char int80_trampoline[],sysenter_trampoline[],trampoline_end[];
+	extern void sysenter_entry(void);
+	unsigned long eax,ebx,ecx,edx;
+	char * from = int80_trampoline, * to = sysenter_trampoline;
+	char * page = trampoline_page;
+	unsigned long base = TASK_BASE + SYSCALL_TRAMPOLINE;
+
+	gdt[SYSCALL_CS>>3].a = (base << 16) | (PAGE_SIZE-1);
+	gdt[SYSCALL_CS>>3].b = (base & 0xff000000) | 0x0040f800 |
+		((base >> 16) & 0xff);
+	if (has_cpuid()) {
+		cpuid(0,eax,ebx,ecx,edx);
+		if (eax >= 1) {
+			cpuid(1,eax,ebx,ecx,edx);
+			if ((edx & 0x800) &&
+			    (((eax>>8) & 0xf) != 6 || (eax & 0xfff) >= 0x633)) {
+				wrmsr(MSR_SYSENTER_CS,0x08,0);
+				wrmsr(MSR_SYSENTER_ESP,
+					(long) (sysenter_stack+16),0);
+				wrmsr(MSR_SYSENTER_EIP,(long) sysenter_entry,0);
+				from = sysenter_trampoline;
+				to = trampoline_end;
+			}
+		}
+	}
+	while (from < to)
+		*page++ = *from++;
+}
+
 void sched_init(void)
 {
 	int i;
@@ -432,7 +512,7 @@ void sched_init(void)
 
 	if (sizeof(struct sigaction) != 16)
 		panic("Struct sigaction MUST be 16 bytes");
-	set_tss_desc(gdt+FIRST_TSS_ENTRY,&(init_task.task.tss));
+	set_tss_desc(gdt+FIRST_TSS_ENTRY,&init_tss);
 	set_ldt_desc(gdt+FIRST_LDT_ENTRY,&(init_task.task.ldt));
 	p = gdt+2+FIRST_TSS_ENTRY;
 	for(i=1;i<NR_TASKS;i++) {
@@ -452,4 +532,10 @@ void sched_init(void)
 	set_intr_gate(0x20,&timer_interrupt);
 	outb(inb_p(0x21)&~0x01,0x21);
 	set_system_gate(0x80,&system_call);
+	trampoline_init();
+	if (!(timer_cache = kmem_cache_create("timer_list",
+	    sizeof(struct timer_list),0,NULL)))
+		panic("Unable to create timer cache");
+/* get the first slab now, so that add_timer() won't have to */
+	kmem_cache_free(timer_cache,kmem_cache_alloc(timer_cache,GFP_KERNEL));
 }
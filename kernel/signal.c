@@ -9,6 +9,7 @@
 #include <asm/segment.h>
 
 #include <signal.h>
+#include <errno.h>
 
 void do_exit(int error_code);
 
@@ -25,16 +26,18 @@ int sys_ssetmask(int newmask)
 	return old;
 }
 
-static inline void save_old(char * from,char * to)
+static inline int save_old(char * from,char * to)
 {
 	int i;
 
-	verify_area(to, sizeof(struct sigaction));
+	if (verify_area(to, sizeof(struct sigaction)))
+		return -EFAULT;
 	for (i=0 ; i< sizeof(struct sigaction) ; i++) {
 		put_fs_byte(*from,to);
 		from++;
 		to++;
 	}
+	return 0;
 }
 
 static inline void get_new(char * from,char * to)
@@ -70,8 +73,10 @@ int sys_sigaction(int signum, const struct sigaction * action,
 	tmp = current->sigaction[signum-1];
 	get_new((char *) action,
 		(char *) (signum-1+current->sigaction));
-	if (oldaction)
-		save_old((char *) &tmp,(char *) oldaction);
+	if (oldaction && save_old((char *) &tmp,(char *) oldaction)) {
+		current->sigaction[signum-1] = tmp;
+		return -EFAULT;
+	}
 	if (current->sigaction[signum-1].sa_flags & SA_NOMASK)
 		current->sigaction[signum-1].sa_mask = 0;
 	else
@@ -112,11 +117,21 @@ void do_signal(long signr,long eax, long ebx, long ecx, long edx,
 		sa->sa_handler = NULL;
     }
 
+/*
+ * Back from an int 0x80 in the trampoline, with only its lret to go: do
+ * that here, so the handler runs in, and returns to, the normal cs.
+ */
+	if (cs == SYSCALL_CS) {
+		old_eip = get_fs_long(esp);
+		*(&esp) += 2;
+		*(&cs) = 0x0f;
+	}
 	*(&eip) = sa_handler;
 
 	longs = (sa->sa_flags & SA_NOMASK)?7:8;// 스택에 비워주는 공간
 	*(&esp) -= longs;
-	verify_area(esp,longs*4);// 미리 공간을 확보
+	if (verify_area(esp,longs*4))// 미리 공간을 확보
+		do_exit(SIGSEGV);
 	tmp_esp=esp;
 	put_fs_long((long) sa->sa_restorer,tmp_esp++);//1
 	put_fs_long(signr,tmp_esp++);//2
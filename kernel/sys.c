@@ -105,7 +105,8 @@ int sys_time(long * tloc)
 
 	i = CURRENT_TIME;
 	if (tloc) {
-		verify_area(tloc,4);
+		if (verify_area(tloc,4))
+			return -EFAULT;
 		put_fs_long(i,(unsigned long *)tloc);
 	}
 	return i;
@@ -156,7 +157,8 @@ int sys_stime(long * tptr)
 int sys_times(struct tms * tbuf)
 {
 	if (tbuf) {
-		verify_area(tbuf,sizeof *tbuf);
+		if (verify_area(tbuf,sizeof *tbuf))
+			return -EFAULT;
 		put_fs_long(current->utime,(unsigned long *)&tbuf->tms_utime);
 		put_fs_long(current->stime,(unsigned long *)&tbuf->tms_stime);
 		put_fs_long(current->cutime,(unsigned long *)&tbuf->tms_cutime);
@@ -165,10 +167,30 @@ int sys_times(struct tms * tbuf)
 	return jiffies;
 }
 
+int sys_vtimes(struct vtms * tbuf)
+{
+	unsigned long * p = (unsigned long *) tbuf;
+
+	if (tbuf) {
+		if (verify_area(tbuf,sizeof *tbuf))
+			return -EFAULT;
+		sys_times((struct tms *) tbuf);
+		put_fs_long(current->min_flt,p+4);
+		put_fs_long(current->maj_flt,p+5);
+		put_fs_long(current->cow_flt,p+6);
+		put_fs_long(current->cmin_flt,p+7);
+		put_fs_long(current->cmaj_flt,p+8);
+		put_fs_long(current->ccow_flt,p+9);
+		put_fs_long(resident_pages(current),p+10);
+	}
+	return jiffies;
+}
+
 int sys_brk(unsigned long end_data_seg)
 {
 	if (end_data_seg >= current->end_code &&
-	    end_data_seg < current->start_stack - 16384)
+	    end_data_seg < current->start_stack - 16384 &&
+	    !vma_overlap(current,current->end_code,end_data_seg))
 		current->brk = end_data_seg;
 	return current->brk;
 }
@@ -221,7 +243,8 @@ int sys_uname(struct utsname * name)
 	int i;
 
 	if (!name) return -ERROR;
-	verify_area(name,sizeof *name);
+	if (verify_area(name,sizeof *name))
+		return -EFAULT;
 	for(i=0;i<sizeof *name;i++)
 		put_fs_byte(((char *) &thisname)[i],i+(char *) name);
 	return 0;
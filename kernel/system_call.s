@@ -58,13 +58,14 @@ sa_mask = 4
 sa_flags = 8
 sa_restorer = 12
 
-nr_system_calls = 74
+nr_system_calls = 83
 
 /*
  * Ok, I get parallel printer interrupts while using the floppy for some
  * strange reason. Urgel. Now I just ignore them.
  */
-.globl system_call,sys_fork,timer_interrupt,sys_execve
+.globl system_call,sys_fork,timer_interrupt,sys_execve,ret_from_fork
+.globl sysenter_entry,int80_trampoline,sysenter_trampoline,trampoline_end
 .globl hd_interrupt,floppy_interrupt,parallel_interrupt
 .globl device_not_available, coprocessor_error
 
@@ -102,8 +103,8 @@ ret_from_sys_call:
 	movl current,%eax		# task[0] cannot have signals
 	cmpl task,%eax
 	je 3f
-	cmpw $0x0f,CS(%esp)		# was old code segment supervisor ?
-	jne 3f
+	testl $3,CS(%esp)		# was old code segment supervisor ?
+	je 3f
 	cmpw $0x17,OLDSS(%esp)		# was stack segment = 0x17 ?
 	jne 3f
 	movl signal(%eax),%ebx
@@ -127,6 +128,70 @@ ret_from_sys_call:
 	pop %ds
 	iret
 
+/*
+ * sysenter lands here with interrupts off, on the little sysenter_stack
+ * (a debug trap can be taken there before the first instruction - see
+ * asm.s), and with whatever NT and TF the user had: get onto the real
+ * kernel stack and clear them before anything else. The trampoline has
+ * saved %ebp and put the user esp in it, so we can pick up the return
+ * address of its lcall and fake the frame an 'int $0x80' would have
+ * pushed, returning straight to the caller. Then it's the normal
+ * system_call path, and iret, as sysexit can't return to the segmented
+ * user space.
+ */
+.align 2
+sysenter_entry:
+	movl current,%esp
+	addl $4096,%esp			# esp0 - see __switch_to()
+	pushl $0
+	popfl
+	pushl $0x17			# oldss
+	pushl %ebp			# oldesp, filled in below
+	pushl $0x200			# eflags - nothing survives a call anyway
+	pushl $0x0f			# cs
+	pushl %ebp			# eip, filled in below
+	sti
+	push %ds
+	pushl %esi
+	movl $0x17,%esi
+	mov %si,%ds
+	movl %ds:4(%ebp),%esi		# the lcall's return address
+	movl %esi,8(%esp)
+	movl %ds:(%ebp),%esi		# the user's ebp
+	addl $12,%ebp			# and its esp after the lret
+	movl %ebp,20(%esp)
+	movl %esi,%ebp
+	popl %esi
+	pop %ds
+	jmp system_call
+
+/*
+ * The system call trampolines. sched_init() copies one of them into the
+ * page that exec maps at SYSCALL_TRAMPOLINE, which is all the SYSCALL_CS
+ * segment covers: they must not contain anything position-dependent.
+ * The sysenter one never returns here. The int 0x80 one does, and if a
+ * signal is delivered then do_signal() does its lret for it.
+ */
+int80_trampoline:
+	int $0x80
+	lret
+sysenter_trampoline:
+	pushl %ebp
+	movl %esp,%ebp
+	sysenter
+trampoline_end:
+
+/*
+ * A newly forked task gets here from its first switch_to(), with the
+ * user esi/edi/ebp on top of a normal system call frame (see copy_process).
+ */
+.align 2
+ret_from_fork:
+	popl %ebp
+	popl %edi
+	popl %esi
+	jmp ret_from_sys_call
+
 .align 2
 coprocessor_error:
 	push %ds
@@ -49,6 +49,10 @@
 #include <linux/mm.h>
 #include <asm/system.h>
 
+#ifndef NULL
+#define NULL ((void *) 0)
+#endif
+
 struct bucket_desc {	/* 16 bytes */
 	void			*page;
 	struct bucket_desc	*next;
@@ -230,3 +234,175 @@ found:
 	return;
 }
 
+
+/*
+ * Object caches are for kernel structures that are allocated and freed
+ * all the time, like timer entries and block device requests. A cache
+ * hands out objects of one size only, from pages of their own ("slabs").
+ * Unlike with the buckets above, the slab header is at the start of the
+ * page itself, so kmem_cache_free() finds it without searching anything.
+ *
+ * Every cache keeps its slabs on three lists: full ones, partly used ones
+ * (which we allocate from first, to keep the others free) and empty ones.
+ * One empty slab is kept around, the others are given back at once. That
+ * way a cache whose objects fit in one slab never needs memory again once
+ * it has had its first page, which matters for GFP_ATOMIC users.
+ *
+ * The constructor (if any) is called on every object handed out: the
+ * free list lives in the objects themselves, so their contents don't
+ * survive being freed.
+ */
+struct slab {
+	struct kmem_cache	*cache;
+	struct slab		*next, *prev;
+	void			*freeptr;
+	unsigned short		inuse;
+};
+
+struct kmem_cache {
+	const char		*name;
+	unsigned short		size;	/* of an object, aligned */
+	unsigned short		num;	/* objects per slab */
+	unsigned short		offset;	/* of the first object in a slab */
+	void			(*ctor)(void *);
+	struct slab		*full, *partial, *empty;
+};
+
+static struct kmem_cache cache_cache = {
+	"kmem_cache", sizeof(struct kmem_cache),
+	(PAGE_SIZE - sizeof(struct slab)) / sizeof(struct kmem_cache),
+	sizeof(struct slab), NULL, NULL, NULL, NULL };
+
+static inline void slab_del(struct slab ** list, struct slab * s)
+{
+	if (s->next)
+		s->next->prev = s->prev;
+	if (s->prev)
+		s->prev->next = s->next;
+	else
+		*list = s->next;
+}
+
+static inline void slab_add(struct slab ** list, struct slab * s)
+{
+	s->prev = NULL;
+	if ((s->next = *list))
+		s->next->prev = s;
+	*list = s;
+}
+
+/*
+ * Get a new slab for the cache. get_free_page() may sleep (unless it's
+ * GFP_ATOMIC), so the slab is set up before it is linked in.
+ */
+static int kmem_cache_grow(struct kmem_cache * cache, int priority)
+{
+	struct slab * s;
+	char * cp;
+	int i;
+	unsigned long flags;
+
+	if (!(s = (struct slab *) __get_free_page(priority)))
+		return 0;
+	s->cache = cache;
+	s->inuse = 0;
+	s->freeptr = cp = cache->offset + (char *) s;
+	for (i = cache->num; i > 1; i--) {
+		*((char **) cp) = cp + cache->size;
+		cp += cache->size;
+	}
+	*((char **) cp) = 0;
+	save_flags(flags);
+	cli();
+	slab_add(&cache->empty, s);
+	restore_flags(flags);
+	return 1;
+}
+
+struct kmem_cache * kmem_cache_create(const char * name, unsigned int size,
+	unsigned int align, void (*ctor)(void *))
+{
+	struct kmem_cache * cache;
+
+	if (!align)
+		align = sizeof(long);
+	if (align & (align-1))
+		panic("kmem_cache_create: bad alignment");
+	if (size < sizeof(void *))
+		size = sizeof(void *);
+	size = (size + align-1) & ~(align-1);
+	if (size > PAGE_SIZE - ((sizeof(struct slab) + align-1) & ~(align-1))) {
+		printk("kmem_cache_create: %s too large (%d)\n", name, size);
+		panic("kmem_cache_create: bad arg");
+	}
+	if (!(cache = kmem_cache_alloc(&cache_cache, GFP_KERNEL)))
+		return NULL;
+	cache->name = name;
+	cache->size = size;
+	cache->offset = (sizeof(struct slab) + align-1) & ~(align-1);
+	cache->num = (PAGE_SIZE - cache->offset) / size;
+	cache->ctor = ctor;
+	cache->full = cache->partial = cache->empty = NULL;
+	return cache;
+}
+
+/*
+ * kmem_cache_alloc() may be called from an interrupt with GFP_ATOMIC.
+ * Returns NULL if there is no memory.
+ */
+void * kmem_cache_alloc(struct kmem_cache * cache, int priority)
+{
+	struct slab * s;
+	void * obj;
+	unsigned long flags;
+
+	save_flags(flags);
+	cli();
+	while (!(s = cache->partial)) {
+		if ((s = cache->empty)) {
+			slab_del(&cache->empty, s);
+			slab_add(&cache->partial, s);
+			break;
+		}
+		restore_flags(flags);
+		if (!kmem_cache_grow(cache, priority))
+			return NULL;
+		cli();
+	}
+	obj = s->freeptr;
+	s->freeptr = *((void **) obj);
+	if (++s->inuse == cache->num) {
+		slab_del(&cache->partial, s);
+		slab_add(&cache->full, s);
+	}
+	restore_flags(flags);
+	if (cache->ctor)
+		cache->ctor(obj);
+	return obj;
+}
+
+void kmem_cache_free(struct kmem_cache * cache, void * obj)
+{
+	struct slab * s;
+	unsigned long flags;
+
+	s = (struct slab *) ((unsigned long) obj & 0xfffff000);
+	if (s->cache != cache)
+		panic("Bad address passed to kmem_cache_free()");
+	save_flags(flags);
+	cli();
+	*((void **) obj) = s->freeptr;
+	s->freeptr = obj;
+	if (s->inuse-- == cache->num) {
+		slab_del(&cache->full, s);
+		slab_add(&cache->partial, s);
+	}
+	if (!s->inuse) {
+		slab_del(&cache->partial, s);
+		if (cache->empty)
+			free_page((unsigned long) s);
+		else
+			slab_add(&cache->empty, s);
+	}
+	restore_flags(flags);
+}
@@ -0,0 +1,34 @@
+/*
+ *  linux/lib/mmap.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/mman.h>
+
+/*
+ * sys_mmap() gets its six arguments in a block, and the address it
+ * returns may look negative: only -4095..-1 are errors.
+ */
+void * mmap(void * addr, size_t len, int prot, int flags, int fildes, off_t off)
+{
+	long args[6];
+	long __res;
+
+	args[0] = (long) addr;
+	args[1] = len;
+	args[2] = prot;
+	args[3] = flags;
+	args[4] = fildes;
+	args[5] = off;
+	__asm__ volatile (__syscall_insn
+		: "=a" (__res)
+		: "0" (__NR_mmap),"b" ((long) args)
+		: "memory");
+	if ((unsigned long) __res < (unsigned long) -4095)
+		return (void *) __res;
+	errno = -__res;
+	return MAP_FAILED;
+}
@@ -0,0 +1,11 @@
+/*
+ *  linux/lib/munmap.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/mman.h>
+
+_syscall2(int,munmap,void *,addr,size_t,len)
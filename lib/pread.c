@@ -0,0 +1,28 @@
+/*
+ *  linux/lib/pread.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+
+/* four arguments: sys_pread() gets them in a block, like sys_sendfile() */
+int pread(int fildes, char * buf, off_t count, off_t offset)
+{
+	long args[4];
+	long __res;
+
+	args[0] = fildes;
+	args[1] = (long) buf;
+	args[2] = count;
+	args[3] = offset;
+	__asm__ volatile (__syscall_insn
+		: "=a" (__res)
+		: "0" (__NR_pread),"b" ((long) args)
+		: "memory");
+	if (__res >= 0)
+		return (int) __res;
+	errno = -__res;
+	return -1;
+}
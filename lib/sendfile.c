@@ -0,0 +1,31 @@
+/*
+ *  linux/lib/sendfile.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+
+/*
+ * sendfile() has four arguments, and only three fit in registers, so
+ * sys_sendfile() gets them in a block.
+ */
+int sendfile(int out_fd, int in_fd, off_t * offset, off_t count)
+{
+	long args[4];
+	long __res;
+
+	args[0] = out_fd;
+	args[1] = in_fd;
+	args[2] = (long) offset;
+	args[3] = count;
+	__asm__ volatile (__syscall_insn
+		: "=a" (__res)
+		: "0" (__NR_sendfile),"b" ((long) args)
+		: "memory");
+	if (__res >= 0)
+		return (int) __res;
+	errno = -__res;
+	return -1;
+}
@@ -0,0 +1,10 @@
+/*
+ *  linux/lib/splice.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+
+_syscall3(int,splice,int,fd_in,int,fd_out,int,len)
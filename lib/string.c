@@ -322,30 +322,57 @@ inline char * strtok(char * s,const char * ct)
         return __res;
 }
 
+/*
+ * memcpy, memmove and memset move longwords, with the odd bytes at the
+ * ends done separately. Longer copies first align the destination, as
+ * misaligned stores are what costs the most.
+ */
 inline void * memcpy(void * dest,const void * src, int n)
 {
-        __asm__ ("cld\n\t"
-                 "rep\n\t"
-                 "movsb"
-                 ::"c" (n),"S" (src),"D" (dest)
-                );
+        int d0,d1,d2,d3;
+        __asm__ __volatile__("cld\n\t"
+                "cmpl $16,%%edx\n\t"
+                "jb 1f\n\t"
+                "movl %%edi,%%ecx\n\t"
+                "negl %%ecx\n\t"
+                "andl $3,%%ecx\n\t"
+                "subl %%ecx,%%edx\n\t"
+                "rep\n\t"
+                "movsb\n"
+                "1:\tmovl %%edx,%%ecx\n\t"
+                "shrl $2,%%ecx\n\t"
+                "rep\n\t"
+                "movsl\n\t"
+                "movl %%edx,%%ecx\n\t"
+                "andl $3,%%ecx\n\t"
+                "rep\n\t"
+                "movsb"
+                :"=&c" (d0),"=&S" (d1),"=&D" (d2),"=&d" (d3)
+                :"3" (n),"1" (src),"2" (dest)
+                :"memory");
         return dest;
 }
 
 inline void * memmove(void * dest,const void * src, int n)
 {
+        int d0,d1,d2,d3;
         if (dest<src)
-                __asm__("cld\n\t"
-                        "rep\n\t"
-                        "movsb"
-                        ::"c" (n),"S" (src),"D" (dest)
-                        );
-        else
-                __asm__("std\n\t"
-                        "rep\n\t"
-                        "movsb"
-                        ::"c" (n),"S" (src+n-1),"D" (dest+n-1)
-                        );
+                return memcpy(dest,src,n);
+        __asm__ __volatile__("std\n\t"
+                "movl %%edx,%%ecx\n\t"
+                "andl $3,%%ecx\n\t"
+                "rep\n\t"
+                "movsb\n\t"
+                "subl $3,%%esi\n\t"
+                "subl $3,%%edi\n\t"
+                "movl %%edx,%%ecx\n\t"
+                "shrl $2,%%ecx\n\t"
+                "rep\n\t"
+                "movsl\n\t"
+                "cld"
+                :"=&c" (d0),"=&S" (d1),"=&D" (d2),"=&d" (d3)
+                :"3" (n),"1" ((char *) src+n-1),"2" ((char *) dest+n-1)
+                :"memory");
         return dest;
 }
 
@@ -383,10 +410,26 @@ inline void * memchr(const void * cs,char c,int count)
 
 static inline void * memset(void * s,char c,int count)
 {
-        __asm__("cld\n\t"
+        int d0,d1,d2;
+        __asm__ __volatile__("cld\n\t"
+                "cmpl $16,%%edx\n\t"
+                "jb 1f\n\t"
+                "movl %%edi,%%ecx\n\t"
+                "negl %%ecx\n\t"
+                "andl $3,%%ecx\n\t"
+                "subl %%ecx,%%edx\n\t"
+                "rep\n\t"
+                "stosb\n"
+                "1:\tmovl %%edx,%%ecx\n\t"
+                "shrl $2,%%ecx\n\t"
+                "rep\n\t"
+                "stosl\n\t"
+                "movl %%edx,%%ecx\n\t"
+                "andl $3,%%ecx\n\t"
                 "rep\n\t"
                 "stosb"
-                ::"a" (c),"D" (s),"c" (count)
-                );
+                :"=&c" (d0),"=&D" (d1),"=&d" (d2)
+                :"a" (0x01010101 * (unsigned char) c),"1" (s),"2" (count)
+                :"memory");
         return s;
 }
\ No newline at end of file
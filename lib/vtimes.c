@@ -0,0 +1,11 @@
+/*
+ *  linux/lib/vtimes.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/times.h>
+
+_syscall1(time_t,vtimes,struct vtms *,tbuf)
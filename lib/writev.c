@@ -0,0 +1,11 @@
+/*
+ *  linux/lib/writev.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/uio.h>
+
+_syscall3(int,writev,int,fd,const struct iovec *,iov,int,iovcnt)
@@ -21,6 +21,8 @@
  */
 
 #include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
 
 #include <asm/system.h>
 
@@ -36,31 +38,18 @@ static inline void oom(void)
 	do_exit(SIGSEGV);
 }
 
-#define invalidate() \
-__asm__("movl %%eax,%%cr3"::"a" (0))
-
-/* these are not to be changed without changing head.s etc */
-#define LOW_MEM 0x100000
-#define PAGING_MEMORY (15*1024*1024)
-#define PAGING_PAGES (PAGING_MEMORY>>12)
-#define MAP_NR(addr) (((addr)-LOW_MEM)>>12)
-#define USED 100
-
 #define CODE_SPACE(addr) ((((addr)+4095)&~4095) < \
 current->start_code + current->end_code)
 
 static long HIGH_MEMORY = 0;
 
-#define copy_page(from,to) \
-__asm__("cld ; rep ; movsl"::"S" (from),"D" (to),"c" (1024))
-
-static unsigned char mem_map [ PAGING_PAGES ] = {0,};
+unsigned char mem_map [ PAGING_PAGES ] = {0,};
 
 /*
  * Get physical address of first (actually last :-) free page, and mark it
- * used. If no free pages left, return 0.
+ * used. If no free pages left, return 0. The page isn't cleared.
  */
-unsigned long get_free_page(void)
+static unsigned long find_free_page(void)
 {
 register unsigned long __res asm("ax");
 
@@ -69,11 +58,7 @@ __asm__("std ; repne ; scasb\n\t"//참조 카운트가 0인 페이지를 선택
 	"movb $1,1(%%edi)\n\t"// 페이지가 선택되면 참조카운트를 1로 설정한다.
 	"sall $12,%%ecx\n\t"
 	"addl %2,%%ecx\n\t"
-	"movl %%ecx,%%edx\n\t"
-	"movl $1024,%%ecx\n\t"
-	"leal 4092(%%edx),%%edi\n\t"
-	"rep ; stosl\n\t"
-	" movl %%edx,%%eax\n"
+	"movl %%ecx,%%eax\n"
 	"1: cld"
 	:"=a" (__res)
 	:"0" (0),"i" (LOW_MEM),"c" (PAGING_PAGES),
@@ -99,23 +84,174 @@ void free_page(unsigned long addr)
 }
 
 /*
- * This function frees a continuos block of page tables, as needed
- * by 'exit()'. As does copy_page_tables(), this handles only 4Mb blocks.
+ * The page cache keeps clean pages of executables and mmap()ed files
+ * around, keyed by (device, inode number, page index), so that they can
+ * be mapped in again without reading them from disk - even when no
+ * process is using the file any more. An executable's pages are those
+ * of its memory image, which starts a block into the file, so pages of
+ * mmap()ed files have FILE_PAGE() set in their index to keep them apart. A cached page holds one mem_map reference of
+ * its own, and is only ever mapped write-protected, so that writes to
+ * it get a copy as with any other shared page.
+ *
+ * Pages that nobody has mapped are given back when we run out of memory
+ * (see get_free_page()), or when the cache is full and a new page comes
+ * in. Writing to or truncating the file, or unmounting its device,
+ * throws away its pages.
  */
-// 31                 22 21              12 11         0
-// |페이지디렉토리아이템|페이지테이블아이템|페이지오프셋|
-int free_page_tables(unsigned long from,unsigned long size)
+#define NR_CACHED_PAGES 512
+#define FILE_PAGE(index) ((index) | 0x80000000)
+#define NR_PAGE_HASH 127
+#define page_hashfn(dev,ino,index) (((unsigned)((dev)^(ino)^(index)))%NR_PAGE_HASH)
+#define inode_hashfn(dev,ino) (((unsigned)((dev)^(ino)))%NR_PAGE_HASH)
+
+struct cached_page {
+	unsigned short dev;
+	unsigned short ino;
+	unsigned long index;
+	unsigned long page;		/* 0 if the entry is free */
+	struct cached_page * next;
+};
+
+static struct cached_page page_cache[NR_CACHED_PAGES];
+static struct cached_page * page_hash[NR_PAGE_HASH];
+/* number of cached pages per inode hash, to make invalidation cheap */
+static unsigned short inode_pages[NR_PAGE_HASH];
+static int page_cache_hand = 0;
+
+static void remove_cached_page(struct cached_page * p)
+{
+	struct cached_page ** q;
+
+	for (q = page_hash + page_hashfn(p->dev,p->ino,p->index) ; *q ; q = &(*q)->next)
+		if (*q == p) {
+			*q = p->next;
+			break;
+		}
+	inode_pages[inode_hashfn(p->dev,p->ino)]--;
+	free_page(p->page);
+	p->page = 0;
+	p->next = NULL;
+}
+
+/*
+ * shrink_page_cache() frees one cached page that isn't mapped by any
+ * process. Returns 1 if it found one, 0 otherwise.
+ */
+static int shrink_page_cache(void)
+{
+	struct cached_page * p;
+	int i;
+
+	for (i=0 ; i<NR_CACHED_PAGES ; i++) {
+		p = page_cache + page_cache_hand;
+		if (++page_cache_hand >= NR_CACHED_PAGES)
+			page_cache_hand = 0;
+		if (p->page && mem_map[MAP_NR(p->page)] == 1) {
+			remove_cached_page(p);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static unsigned long find_cached_page(struct m_inode * inode, unsigned long index)
+{
+	struct cached_page * p;
+
+	for (p = page_hash[page_hashfn(inode->i_dev,inode->i_num,index)] ; p ; p = p->next)
+		if (p->index == index && p->ino == inode->i_num && p->dev == inode->i_dev)
+			return p->page;
+	return 0;
+}
+
+/*
+ * add_cached_page() enters 'page' into the cache, taking a reference
+ * of its own. Returns 0 if there was no room.
+ */
+static int add_cached_page(struct m_inode * inode, unsigned long index,
+	unsigned long page)
+{
+	struct cached_page * p;
+	int i;
+
+	for (i=0 ; i<NR_CACHED_PAGES ; i++)
+		if (!page_cache[i].page)
+			break;
+	if (i >= NR_CACHED_PAGES) {
+		if (!shrink_page_cache())
+			return 0;
+		for (i=0 ; i<NR_CACHED_PAGES ; i++)
+			if (!page_cache[i].page)
+				break;
+	}
+	p = page_cache + i;
+	p->dev = inode->i_dev;
+	p->ino = inode->i_num;
+	p->index = index;
+	p->page = page;
+	mem_map[MAP_NR(page)]++;
+	i = page_hashfn(p->dev,p->ino,index);
+	p->next = page_hash[i];
+	page_hash[i] = p;
+	inode_pages[inode_hashfn(p->dev,p->ino)]++;
+	return 1;
+}
+
+void invalidate_inode_pages(struct m_inode * inode)
+{
+	int i;
+
+	if (!inode_pages[inode_hashfn(inode->i_dev,inode->i_num)])
+		return;
+	for (i=0 ; i<NR_CACHED_PAGES ; i++)
+		if (page_cache[i].page && page_cache[i].ino == inode->i_num &&
+		    page_cache[i].dev == inode->i_dev)
+			remove_cached_page(page_cache+i);
+}
+
+void invalidate_dev_pages(int dev)
+{
+	int i;
+
+	for (i=0 ; i<NR_CACHED_PAGES ; i++)
+		if (page_cache[i].page && page_cache[i].dev == dev)
+			remove_cached_page(page_cache+i);
+}
+
+/*
+ * get_free_page() falls back to dropping unused cached pages when memory
+ * is full, and then to swapping pages out. Returns 0 if neither helps.
+ *
+ * NOTE! This means get_free_page() can sleep, and callers that look at
+ * page tables have to look again afterwards. GFP_ATOMIC callers only
+ * get what is free right now.
+ */
+unsigned long __get_free_page(int priority)
+{
+	unsigned long page, flags;
+
+	for (;;) {
+		/* interrupts may want a page too */
+		save_flags(flags);
+		cli();
+		page = find_free_page();
+		restore_flags(flags);
+		if (page) {
+			clear_page(page);
+			return page;
+		}
+		if (priority == GFP_ATOMIC)
+			return 0;
+		if (!shrink_page_cache() && !swap_out())
+			return 0;
+	}
+}
+
+/* free the pages and page tables of 'size' page directory entries */
+static void free_dir(unsigned long * dir, unsigned long size)
 {
 	unsigned long *pg_table;
-	unsigned long * dir, nr;
-	/// 0x3fffff 는 4MB로 페이지 테이블이 관리할 수 있는 영역
-	if (from & 0x3fffff)
-		panic("free_page_tables called with wrong alignment");
-	if (!from)
-		panic("Trying to free up swapper memory space");
-	size = (size + 0x3fffff) >> 22;
-	//페이지 디렉터리 인덱스  
-	dir = (unsigned long *) ((from>>20) & 0xffc); /* _pg_dir = 0 */
+	unsigned long nr;
 
 	//size 페이지 디렉터리의 개수 
 	for ( ; size-->0 ; dir++) {
@@ -128,16 +264,88 @@ int free_page_tables(unsigned long from,unsigned long size)
 		{
 			if (1 & *pg_table)
 				free_page(0xfffff000 & *pg_table);
+			else if (*pg_table)
+				swap_free(*pg_table >> 1);
 			*pg_table = 0;
 			pg_table++;
 		}
 		free_page(0xfffff000 & *dir);
 		*dir = 0;
 	}
+}
+
+/*
+ * This function frees a continuos block of page tables, as needed
+ * by 'exit()'. As does copy_page_tables(), this handles only 4Mb blocks.
+ */
+// 31                 22 21              12 11         0
+// |페이지디렉토리아이템|페이지테이블아이템|페이지오프셋|
+int free_page_tables(unsigned long from,unsigned long size)
+{
+	/// 0x3fffff 는 4MB로 페이지 테이블이 관리할 수 있는 영역
+	if (from & 0x3fffff)
+		panic("free_page_tables called with wrong alignment");
+	if (from < TASK_BASE)
+		panic("Trying to free up swapper memory space");
+	//페이지 디렉터리 인덱스  
+	free_dir(dir_entry(current,from),(size + 0x3fffff) >> 22);
 	invalidate();
 	return 0;
 }
 
+/*
+ * unmap_page_range() frees the pages (and swap entries) of the current
+ * task from 'from' to from+size, both page aligned. Page tables that the
+ * range covers completely go too, as in free_page_tables().
+ */
+void unmap_page_range(unsigned long from, unsigned long size)
+{
+	unsigned long * dir, * pg_table, page;
+
+	for ( ; size ; from += PAGE_SIZE, size -= PAGE_SIZE) {
+		dir = dir_entry(current,from);
+		if (!(from & 0x3fffff) && size >= 0x400000) {
+			free_dir(dir,1);
+			from += 0x400000 - PAGE_SIZE;
+			size -= 0x400000 - PAGE_SIZE;
+			continue;
+		}
+		if (!(1 & *dir))
+			continue;
+		pg_table = (unsigned long *) (0xfffff000 & *dir);
+		pg_table += (from >> 12) & 0x3ff;
+		if (!(page = *pg_table))
+			continue;
+		*pg_table = 0;
+		if (1 & page)
+			free_page(0xfffff000 & page);
+		else
+			swap_free(page >> 1);
+	}
+	invalidate();
+}
+
+/*
+ * resident_pages() counts the pages present in a task's address space.
+ */
+int resident_pages(struct task_struct * p)
+{
+	unsigned long * dir, * pg_table;
+	int i, nr, res = 0;
+
+	if (!p->start_code)	/* task 0 runs in the kernel */
+		return 0;
+	dir = dir_entry(p,TASK_BASE);
+	for (i=0 ; i<(TASK_SIZE>>22) ; i++,dir++) {
+		if (!(1 & *dir))
+			continue;
+		pg_table = (unsigned long *) (0xfffff000 & *dir);
+		for (nr=0 ; nr<1024 ; nr++)
+			res += 1 & pg_table[nr];
+	}
+	return res;
+}
+
 /*
  *  Well, here is one of the most complicated functions in mm. It
  * copies a range of linerar addresses by copying only the pages.
@@ -154,8 +362,12 @@ int free_page_tables(unsigned long from,unsigned long size)
  * doesn't take any more memory - we don't copy-on-write in the low
  * 1 Mb-range, so the pages can be shared with the kernel. Thus the
  * special case for nr=xxxx.
+ *
+ * 'from' is in the current task's page directory, 'to' in that of 'p'.
+ * If we run out of memory, whatever was copied to 'p' is freed again.
  */
-int copy_page_tables(unsigned long from,unsigned long to,long size)
+int copy_page_tables(unsigned long from,unsigned long to,long size,
+	struct task_struct * p)
 {
 	unsigned long * from_page_table;
 	unsigned long * to_page_table;
@@ -165,8 +377,8 @@ int copy_page_tables(unsigned long from,unsigned long to,long size)
 
 	if ((from&0x3fffff) || (to&0x3fffff))
 		panic("copy_page_tables called with wrong alignment");
-	from_dir = (unsigned long *) ((from>>20) & 0xffc); /* _pg_dir = 0 */
-	to_dir = (unsigned long *) ((to>>20) & 0xffc);
+	from_dir = dir_entry(current,from);
+	to_dir = dir_entry(p,to);
 	size = ((unsigned) (size+0x3fffff)) >> 22;
 	for( ; size-->0 ; from_dir++,to_dir++) {
 		if (1 & *to_dir)
@@ -175,13 +387,25 @@ int copy_page_tables(unsigned long from,unsigned long to,long size)
 			continue;
 		from_page_table = (unsigned long *) (0xfffff000 & *from_dir);
 		if (!(to_page_table = (unsigned long *) get_free_page()))
-			return -1;	/* Out of memory, see freeing */
+			goto out_of_memory;
 		*to_dir = ((unsigned long) to_page_table) | 7;
 		nr = (from==0)?0xA0:1024;
+/* the kernel may be mapped with 4Mb pages: give the child page tables */
+		if (*from_dir & 0x80) {
+			this_page = (*from_dir & 0xffc00000) | (*from_dir & 7);
+			for ( ; nr-- > 0 ; to_page_table++,this_page += 4096)
+				*to_page_table = this_page & ~2;
+			continue;
+		}
 		for ( ; nr-- > 0 ; from_page_table++,to_page_table++) {
 			this_page = *from_page_table;
-			if (!(1 & this_page))
+			if (!this_page)
+				continue;
+			if (!(1 & this_page)) {
+				if (!swap_fork(from_page_table,to_page_table))
+					goto out_of_memory;
 				continue;
+			}
 			this_page &= ~2;
 			*to_page_table = this_page;
 			if (this_page > LOW_MEM) {
@@ -194,6 +418,10 @@ int copy_page_tables(unsigned long from,unsigned long to,long size)
 	}
 	invalidate();
 	return 0;
+out_of_memory:
+	free_dir(dir_entry(p,to),((unsigned) (to_dir-dir_entry(p,to)))+1);
+	invalidate();
+	return -1;
 }
 
 /*
@@ -202,12 +430,11 @@ int copy_page_tables(unsigned long from,unsigned long to,long size)
  * out of memory (either when trying to access page-table or
  * page.)
  */
-unsigned long put_page(unsigned long page,unsigned long address)
+static unsigned long __put_page(unsigned long page,unsigned long address,
+	unsigned long flags)
 {
 	unsigned long tmp, *page_table;
 
-/* NOTE !!! This uses the fact that _pg_dir=0 */
-
 	if (page < LOW_MEM || page >= HIGH_MEMORY)
 		printk("Trying to put page %p at %p\n",page,address);
 
@@ -215,7 +442,7 @@ unsigned long put_page(unsigned long page,unsigned long address)
 		printk("mem_map disagrees with %p at %p\n",page,address);
  
     // address 에서 페이지 디렉토리 테이블 엔트리를 계산
-	page_table = (unsigned long *) ((address>>20) & 0xffc);
+	page_table = dir_entry(current,address);
 
     // 페이지 디렉토리 엔드리가 페이지 테이블를 가지고 있으면
 	if ((*page_table)&1)
@@ -232,16 +459,70 @@ unsigned long put_page(unsigned long page,unsigned long address)
 	}
 
     // 페이지와 페이지 테이블 관계를 만들고 맵핑
-	page_table[(address>>12) & 0x3ff] = page | 7;
+	page_table[(address>>12) & 0x3ff] = page | flags;
 /* no need for invalidate */
 	return page;
 }
 
+unsigned long put_page(unsigned long page,unsigned long address)
+{
+	return __put_page(page,address,7);
+}
+
+/*
+ * put_dirty_page() is for pages whose contents can't be had again from
+ * anywhere but swap, like the exec arguments: swap_out() drops clean
+ * pages.
+ */
+unsigned long put_dirty_page(unsigned long page,unsigned long address)
+{
+	return __put_page(page,address,PAGE_DIRTY | 7);
+}
+
+/*
+ * put_kernel_page() maps a page of the kernel image read-only at the
+ * wanted address. Such pages are below LOW_MEM, so fork and exit share
+ * and "free" them without counting them.
+ */
+static unsigned long put_kernel_page(unsigned long page,unsigned long address)
+{
+	unsigned long tmp, *page_table;
+
+	page_table = dir_entry(current,address);
+	if ((*page_table)&1)
+		page_table = (unsigned long *) (0xfffff000 & *page_table);
+	else {
+		if (!(tmp=get_free_page()))
+			return 0;
+		*page_table = tmp|7;
+		page_table = (unsigned long *) tmp;
+	}
+	page_table[(address>>12) & 0x3ff] = page | 5;
+	return page;
+}
+
+/* the system call trampoline page, see sched.c */
+unsigned long put_trampoline(unsigned long address)
+{
+	extern char trampoline_page[];
+
+	return put_kernel_page((unsigned long) trampoline_page,address);
+}
+
+/*
+ * empty_zero_page is mapped for reads of memory that hasn't been written
+ * yet (bss, brk and stack): the first write gets a page of its own in
+ * un_wp_page().
+ */
+static char empty_zero_page[PAGE_SIZE] __attribute__((aligned(PAGE_SIZE))) = {0,};
+#define ZERO_PAGE ((unsigned long) empty_zero_page)
+
 void un_wp_page(unsigned long * table_entry)
 {
-	unsigned long old_page,new_page;
+	unsigned long old_entry,old_page,new_page;
 
-	old_page = 0xfffff000 & *table_entry;
+	old_entry = *table_entry;
+	old_page = 0xfffff000 & old_entry;
 	if (old_page >= LOW_MEM && mem_map[MAP_NR(old_page)]==1)
 	{
 		*table_entry |= 2;
@@ -250,11 +531,18 @@ void un_wp_page(unsigned long * table_entry)
 	}
 	if (!(new_page=get_free_page()))
 		oom();
+/* get_free_page() may have swapped the page out: if so, just fault again */
+	if (*table_entry != old_entry) {
+		free_page(new_page);
+		return;
+	}
+	current->cow_flt++;
 	if (old_page >= LOW_MEM)
 		mem_map[MAP_NR(old_page)]--;
-	*table_entry = new_page | 7;
+	*table_entry = new_page | PAGE_DIRTY | 7;	/* a copy: swap it, don't drop it */
 	invalidate();
-	copy_page(old_page,new_page);
+	if (old_page != ZERO_PAGE)	/* get_free_page() already cleared it */
+		copy_page(old_page,new_page);
 }	
 
 /*
@@ -266,6 +554,16 @@ void un_wp_page(unsigned long * table_entry)
  */
 void do_wp_page(unsigned long error_code,unsigned long address)
 {
+	struct vm_area * vma;
+
+/*
+ * Writes to a read-only mmap() are errors. verify_area() keeps the kernel
+ * out of them, so if it gets here anyway nobody checked, and there's
+ * nothing to back out to either.
+ */
+	vma = find_vma(current,address - current->start_code);
+	if (vma && !(vma->prot & PROT_WRITE))
+		do_exit(SIGSEGV);
 #if 0
 /* we cannot do this yet: the estdio library writes to code space */
 /* stupid, stupid. I really want the libc.a from GNU */
@@ -274,7 +572,8 @@ void do_wp_page(unsigned long error_code,unsigned long address)
 #endif
 	un_wp_page((unsigned long *)
 		(((address>>10) & 0xffc) + (0xfffff000 &
-		*((unsigned long *) ((address>>20) &0xffc)))));
+		*dir_entry(current,address))));
+	current->min_flt++;
 
 }
 // 메모리 공간의 유효성을 검사
@@ -282,7 +581,7 @@ void write_verify(unsigned long address)
 {
 	unsigned long page;
 
-	if (!( (page = *((unsigned long *) ((address>>20) & 0xffc)) )&1))
+	if (!( (page = *dir_entry(current,address)) &1))
 		return;
 	page &= 0xfffff000;
 	page += ((address>>10) & 0xffc);
@@ -319,9 +618,16 @@ static int try_to_share(unsigned long address, struct task_struct * p)
 	unsigned long to_page;
 	unsigned long phys_addr;
 
-	from_page = to_page = ((address>>20) & 0xffc);
-	from_page += ((p->start_code>>20) & 0xffc);
-	to_page += ((current->start_code>>20) & 0xffc);
+	from_page = (unsigned long) dir_entry(p,p->start_code+address);
+	to_page = (unsigned long) dir_entry(current,current->start_code+address);
+/* get the page table at to first: get_free_page() may sleep */
+	to = *(unsigned long *) to_page;
+	if (!(to & 1)) {
+		if ((to = get_free_page()))
+			*(unsigned long *) to_page = to | 7;
+		else
+			oom();
+	}
 /* is there a page-directory at from? */
 	from = *(unsigned long *) from_page;
 	if (!(from & 1))
@@ -335,13 +641,6 @@ static int try_to_share(unsigned long address, struct task_struct * p)
 	phys_addr &= 0xfffff000;
 	if (phys_addr >= HIGH_MEMORY || phys_addr < LOW_MEM)
 		return 0;
-	to = *(unsigned long *) to_page;
-	if (!(to & 1)) {
-		if ((to = get_free_page()))
-			*(unsigned long *) to_page = to | 7;
-		else
-			oom();
-	}
 	to &= 0xfffff000;
 	to_page = to + ((address>>10) & 0xffc);
 	if (1 & *(unsigned long *) to_page)
@@ -396,56 +695,297 @@ static int share_page(unsigned long address)
 	return 0;
 }
 
+/*
+ * Number of pages around a text/data fault that are mapped as well if
+ * that can be done without waiting, and the number of pages after it
+ * that are read ahead.
+ */
+#define FAULT_AROUND	4
+#define FAULT_AHEAD	8
+
+/* the blocks of the executable holding the page at 'tmp' */
+static void exec_blocks(unsigned long tmp, int nr[4])
+{
+	int block,i;
+
+/* remember that 1 block is used for header */
+	block = 1 + tmp/BLOCK_SIZE;     // block = 읽고 싶은 메모리 주소가 위치한 block 위치
+	for (i=0 ; i<4 ; block++,i++)   // 4 -> 한block 이 1024 이고 page 가 4096 이라서 4번 읽어야 page에 데이터를 채움
+		nr[i] = bmap(current->executable,block);
+}
+
+/*
+ * exec_page() gets a page and reads the executable's page at 'tmp' into
+ * it, clearing whatever lies beyond end_data. Returns 0 if out of memory.
+ */
+static unsigned long exec_page(unsigned long tmp, int nr[4])
+{
+	unsigned long page;
+	int i;
+
+	if (!(page = get_free_page()))
+		return 0;
+	bread_page(page,current->executable->i_dev,nr);
+
+    // 나머지 공간에 0으로 초기화
+	i = tmp + 4096 - current->end_data;
+	tmp = page + 4096;
+	while (i-- > 0) {
+		tmp--;
+		*(char *)tmp = 0;
+	}
+	return page;
+}
+
+/*
+ * map_cached_page() maps page 'index' of the inode from the page cache,
+ * write-protected. Returns 0 if it isn't cached.
+ */
+static int map_cached_page(unsigned long address, struct m_inode * inode,
+	unsigned long index)
+{
+	unsigned long tmp, page, *page_table;
+
+	if (!(page = find_cached_page(inode,index)))
+		return 0;
+	mem_map[MAP_NR(page)]++;
+	page_table = dir_entry(current,address);
+	if ((*page_table)&1)
+		page_table = (unsigned long *) (0xfffff000 & *page_table);
+	else {
+		if (!(tmp=get_free_page())) {
+			free_page(page);
+			return 0;
+		}
+		*page_table = tmp|7;
+		page_table = (unsigned long *) tmp;
+	}
+	page_table[(address>>12) & 0x3ff] = page | 5;
+	return 1;
+}
+
+/*
+ * put_cached_page() maps a freshly read page 'index' of the inode, and
+ * puts it in the page cache if there's room. Returns 0 if out of memory.
+ */
+static int put_cached_page(unsigned long page, unsigned long address,
+	struct m_inode * inode, unsigned long index)
+{
+	unsigned long * page_table;
+
+	if (!put_page(page,address))
+		return 0;
+	if (add_cached_page(inode,index,page)) {
+		page_table = (unsigned long *) (0xfffff000 &
+			*dir_entry(current,address));
+		page_table[(address>>12) & 0x3ff] &= ~2;
+	}
+	return 1;
+}
+
+/* the page table entry for 'address', 0 if there is none */
+static unsigned long page_entry(unsigned long address)
+{
+	unsigned long page;
+
+	page = *dir_entry(current,address);
+	if (!(page & 1))
+		return 0;
+	page &= 0xfffff000;
+	return *(unsigned long *) (page + ((address>>10) & 0xffc));
+}
+
+/*
+ * fault_around() is called once a fault in the executable's text or data
+ * at 'address' has been dealt with. Pages around it that can be had
+ * without waiting (shared with another process, or all blocks in the
+ * buffer cache) get mapped too, and reading of the pages after it is
+ * started, so that a program starts up in a handful of faults instead
+ * of taking a disk round trip for every page.
+ */
+static void fault_around(unsigned long address)
+{
+	unsigned long addr, end, tmp, page;
+	int nr[4];
+
+	addr = address - current->start_code;
+	addr = (addr > FAULT_AROUND*PAGE_SIZE) ? address - FAULT_AROUND*PAGE_SIZE
+		: current->start_code;
+	end = address + FAULT_AHEAD*PAGE_SIZE;
+	for ( ; addr <= end ; addr += PAGE_SIZE) {
+		tmp = addr - current->start_code;
+		if (tmp >= current->end_data)
+			break;
+		if (addr == address || page_entry(addr))
+			continue;
+		if (addr <= address + FAULT_AROUND*PAGE_SIZE &&
+		    (map_cached_page(addr,current->executable,tmp>>12) ||
+		     share_page(tmp)))
+			continue;
+		exec_blocks(tmp,nr);
+		if (!page_cached(current->executable->i_dev,nr)) {
+			if (addr > address)
+				bread_page_ahead(current->executable->i_dev,nr);
+			continue;
+		}
+		if (addr > address + FAULT_AROUND*PAGE_SIZE)
+			continue;
+		if (!(page = exec_page(tmp,nr)))
+			return;
+		if (!put_cached_page(page,addr,current->executable,tmp>>12)) {
+			free_page(page);
+			return;
+		}
+	}
+}
+
+/*
+ * mmap_no_page() brings in a page of an mmap()ed file, through the page
+ * cache like the executable's pages. What lies beyond the end of the
+ * file reads as zeroes. Anonymous areas are done like the heap.
+ */
+static void mmap_no_page(struct vm_area * vma, unsigned long error_code,
+	unsigned long address, unsigned long tmp)
+{
+	struct m_inode * inode = vma->inode;
+	unsigned long index, block, page, * page_table;
+	int nr[4], i;
+
+	if (!inode) {
+		current->min_flt++;
+		if ((!(error_code & 2) || !(vma->prot & PROT_WRITE)) &&
+		    put_kernel_page(ZERO_PAGE,address))
+			return;
+		get_empty_page(address);
+		return;
+	}
+	index = (tmp - vma->start + vma->offset) >> 12;
+	if (map_cached_page(address,inode,FILE_PAGE(index))) {
+		current->min_flt++;
+		return;
+	}
+/* blocks past the end of the file are holes: bmap() mustn't see them */
+	block = index << 2;
+	for (i=0 ; i<4 ; i++,block++)
+		if (block < MAX_FILE_BLOCKS && block*BLOCK_SIZE < inode->i_size)
+			nr[i] = bmap(inode,block);
+		else
+			nr[i] = 0;
+	if (page_cached(inode->i_dev,nr))
+		current->min_flt++;
+	else
+		current->maj_flt++;
+	if (!(page = get_free_page()))
+		oom();
+	bread_page(page,inode->i_dev,nr);
+	i = ((index+1) << 12) - inode->i_size;
+	if (i > PAGE_SIZE)
+		i = PAGE_SIZE;
+	if (i > 0)
+		memset((char *) page + PAGE_SIZE - i,0,i);
+	if (!put_cached_page(page,address,inode,FILE_PAGE(index))) {
+		free_page(page);
+		oom();
+	}
+	if (!(vma->prot & PROT_WRITE)) {
+		page_table = (unsigned long *) (0xfffff000 &
+			*dir_entry(current,address));
+		page_table[(address>>12) & 0x3ff] &= ~2;
+	}
+}
+
 void do_no_page(unsigned long error_code,unsigned long address)
 // address : fault난 주소
 {
 	int nr[4];
 	unsigned long tmp;
 	unsigned long page;
-	int block,i;
+	struct vm_area * vma;
 
 	address &= 0xfffff000; // fault난 페이지의 시작 주소
-	tmp = address - current->start_code; // start_code : 4G중 프로세스의 시작 주소(p x 64M)
+
+	// swap out 된 페이지면 swap in 한다.
+	page = *dir_entry(current,address);
+	if (page & 1) {
+		page &= 0xfffff000;
+		page += (address >> 10) & 0xffc;
+		if (*(unsigned long *) page) {
+			if (!swap_in((unsigned long *) page))
+				oom();
+			current->maj_flt++;
+			return;
+		}
+	}
+
+	tmp = address - current->start_code; // start_code : 유저 공간의 시작 주소(TASK_BASE)
+
+	// mmap 된 영역이면 파일에서 읽어온다.
+	if ((vma = find_vma(current,tmp))) {
+		mmap_no_page(vma,error_code,address,tmp);
+		return;
+	}
 
 	// 코드, 데이터 영역이 아닌 힙, 스택영역에서 폴트가 발생 한 경우. 빈 페이지만 넘겨준다.
 	if (!current->executable || tmp >= current->end_data) 
     {
+		current->min_flt++;
         // 로딩이 필요한 것이 아니다.
+		// 읽기라면 공유 zero page 를 매핑한다.
+		if (!(error_code & 2) && put_kernel_page(ZERO_PAGE,address))
+			return;
 		get_empty_page(address);    // 스택이 부족한 경우라면 페이지를 새로 할당 
 		return;
 	}
 
     // 코드 영역과, 데이터 영역을 읽는 부분 BSS는 0이기때문에 안읽어도됨.
     // end_data = code + data
-    // 다른 프로세스의 메모리를 공유 받는다.
-	if (share_page(tmp))
-		return;
-
-	if (!(page = get_free_page()))
-		oom();
-
-/* remember that 1 block is used for header */
-	block = 1 + tmp/BLOCK_SIZE;     // block = 읽고 싶은 메모리 주소가 위치한 block 위치
-	for (i=0 ; i<4 ; block++,i++)   // 4 -> 한block 이 1024 이고 page 가 4096 이라서 4번 읽어야 page에 데이터를 채움
-		nr[i] = bmap(current->executable,block);
+    // 페이지 캐시에 있거나, 다른 프로세스의 메모리를 공유 받는다.
+	if (map_cached_page(address,current->executable,tmp>>12) ||
+	    share_page(tmp))
+		current->min_flt++;
+	else {
+		exec_blocks(tmp,nr);
+		if (page_cached(current->executable->i_dev,nr))
+			current->min_flt++;
+		else
+			current->maj_flt++;
+		if (!(page = exec_page(tmp,nr)))
+			oom();
+	    // page 를 선형address 와 연결
+		if (!put_cached_page(page,address,current->executable,tmp>>12)) {
+		    // 에러처리
+			free_page(page);
+			oom();
+		}
+	}
+	fault_around(address);
+}
 
-	bread_page(page,current->executable->i_dev,nr);
+/*
+ * paging_init() extends the kernel's identity mapping from the 16Mb that
+ * head.s sets up to all of memory - which can't be more than the 64Mb
+ * below TASK_BASE. With 4Mb pages that's just page directory
+ * entries, otherwise the page tables are taken from the start of main
+ * memory. Returns the new start of main memory.
+ */
+long paging_init(long start_mem, long end_mem)
+{
+	unsigned long * pg_table, addr;
+	int i;
 
-    // 나머지 공간에 0으로 초기화
-	i = tmp + 4096 - current->end_data;
-	tmp = page + 4096;
-	while (i-- > 0) {
-		tmp--;
-		*(char *)tmp = 0;
+	for (addr = 16*1024*1024 ; addr < end_mem ; addr += 0x400000) {
+		if (pg_dir[0] & 0x80) {
+			pg_dir[addr>>22] = addr | 0x87;
+			continue;
+		}
+		pg_table = (unsigned long *) start_mem;
+		start_mem += 4096;
+		for (i=0 ; i<1024 ; i++)
+			pg_table[i] = (addr + (i<<12)) | 7;
+		pg_dir[addr>>22] = (unsigned long) pg_table | 7;
 	}
-
-    // page 를 선형address 와 연결
-	if (put_page(page,address))
-		return;
-    
-    // 에러처리
-	free_page(page);
-	oom();
+	invalidate();
+	return start_mem;
 }
 
 void mem_init(long start_mem, long end_mem)
@@ -466,13 +1006,14 @@ void calc_mem(void)
 {
 	int i,j,k,free=0;
 	long * pg_tbl;
+	unsigned long * dir = (unsigned long *) current->tss.cr3;
 
 	for(i=0 ; i<PAGING_PAGES ; i++)
 		if (!mem_map[i]) free++;
 	printk("%d pages free (of %d)\n\r",free,PAGING_PAGES);
 	for(i=2 ; i<1024 ; i++) {
-		if (1&pg_dir[i]) {
-			pg_tbl=(long *) (0xfffff000 & pg_dir[i]);
+		if ((1&dir[i]) && !(0x80&dir[i])) {
+			pg_tbl=(long *) (0xfffff000 & dir[i]);
 			for(j=k=0 ; j<1024 ; j++)
 				if (pg_tbl[j]&1)
 					k++;
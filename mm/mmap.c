@@ -0,0 +1,207 @@
+/*
+ *  linux/mm/mmap.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+/*
+ * mmap() and munmap(). Only regular files can be mapped, and only
+ * read-only or private: nothing is ever written back to the file. The
+ * pages are faulted in by do_no_page() through the page cache, so clean
+ * pages of a file are shared by everybody who has them mapped, and a
+ * private write gets a copy of its own in un_wp_page().
+ *
+ * MAP_ANONYMOUS areas have no file, and fault in zero-filled pages like
+ * the heap does. They give malloc()s something other than one brk heap
+ * for big objects, that can be given back with munmap().
+ */
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/mm.h>
+#include <asm/segment.h>
+
+struct vm_area * find_vma(struct task_struct * p, unsigned long addr)
+{
+	struct vm_area * vma;
+
+	for (vma = p->mmap ; vma < p->mmap + NR_VMA ; vma++)
+		if (vma->end && addr >= vma->start && addr < vma->end)
+			return vma;
+	return NULL;
+}
+
+int vma_overlap(struct task_struct * p, unsigned long start,
+	unsigned long end)
+{
+	struct vm_area * vma;
+
+	for (vma = p->mmap ; vma < p->mmap + NR_VMA ; vma++)
+		if (vma->end && vma->start < end && start < vma->end)
+			return 1;
+	return 0;
+}
+
+static struct vm_area * get_empty_vma(void)
+{
+	struct vm_area * vma;
+
+	for (vma = current->mmap ; vma < current->mmap + NR_VMA ; vma++)
+		if (!vma->end)
+			return vma;
+	return NULL;
+}
+
+/* first fit from MMAP_BASE up: returns 0 if there's no room */
+static unsigned long get_unmapped_area(unsigned long len)
+{
+	unsigned long addr = MMAP_BASE;
+	struct vm_area * vma;
+
+	if (addr < current->brk)
+		addr = (current->brk + 0xfff) & 0xfffff000;
+repeat:
+	if (addr + len < addr || addr + len > MMAP_TOP(current))
+		return 0;
+	for (vma = current->mmap ; vma < current->mmap + NR_VMA ; vma++)
+		if (vma->end && vma->start < addr + len && addr < vma->end) {
+			addr = vma->end;
+			goto repeat;
+		}
+	return addr;
+}
+
+/*
+ * do_munmap() takes [addr,addr+len) out of the areas it overlaps, which
+ * means splitting one in two if the hole is in the middle of it.
+ */
+static int do_munmap(unsigned long addr, unsigned long len)
+{
+	struct vm_area * vma, * new;
+	unsigned long end = addr + len, start, stop;
+
+	for (vma = current->mmap ; vma < current->mmap + NR_VMA ; vma++) {
+		if (!vma->end || vma->start >= end || addr >= vma->end)
+			continue;
+		if (vma->start < addr && end < vma->end) {
+			if (!(new = get_empty_vma()))
+				return -ENOMEM;
+			*new = *vma;
+			new->offset += end - vma->start;
+			new->start = end;
+			if (new->inode)
+				new->inode->i_count++;
+			vma->end = end;
+		}
+		start = (addr > vma->start) ? addr : vma->start;
+		stop = (end < vma->end) ? end : vma->end;
+		unmap_page_range(current->start_code + start, stop - start);
+		if (start == vma->start && stop == vma->end) {
+			iput(vma->inode);
+			vma->inode = NULL;
+			vma->end = 0;
+		} else if (start == vma->start) {
+			vma->offset += stop - start;
+			vma->start = stop;
+		} else
+			vma->end = start;
+	}
+	return 0;
+}
+
+/*
+ * sys_mmap() has six arguments, so they are passed in a block in user
+ * memory: addr, len, prot, flags, fd, off. It returns the address, which
+ * may well look negative: only -4095..-1 are errors.
+ */
+int sys_mmap(unsigned long * args)
+{
+	unsigned long addr, len, off;
+	int prot, flags, fd;
+	struct file * file;
+	struct m_inode * inode;
+	struct vm_area * vma;
+
+	addr = get_fs_long(args);
+	len = get_fs_long(args+1);
+	prot = get_fs_long(args+2);
+	flags = get_fs_long(args+3);
+	fd = get_fs_long(args+4);
+	off = get_fs_long(args+5);
+	len = (len + 0xfff) & 0xfffff000;
+	if (!len || (addr & 0xfff) || (off & 0xfff))
+		return -EINVAL;
+	if (!(prot & (PROT_READ | PROT_WRITE | PROT_EXEC)))
+		return -EINVAL;
+	switch (flags & MAP_TYPE) {
+		case MAP_SHARED:
+			if (prot & PROT_WRITE)	/* we can't write back */
+				return -EINVAL;
+		case MAP_PRIVATE:
+			break;
+		default:
+			return -EINVAL;
+	}
+	if (flags & MAP_ANONYMOUS) {
+		if ((flags & MAP_TYPE) != MAP_PRIVATE)
+			return -EINVAL;
+		inode = NULL;
+		off = 0;
+	} else {
+		if (fd >= NR_OPEN || fd < 0 || !(file = current->filp[fd]))
+			return -EBADF;
+		if (!(file->f_mode & 1))
+			return -EACCES;
+		inode = file->f_inode;
+		if (!S_ISREG(inode->i_mode))
+			return -ENODEV;
+		if (off >= MAX_FILE_BLOCKS*BLOCK_SIZE)
+			return -EINVAL;
+	}
+	if (flags & MAP_FIXED) {
+		if (addr < current->brk || addr + len < addr ||
+		    addr + len > MMAP_TOP(current))
+			return -EINVAL;
+		if (do_munmap(addr,len))
+			return -ENOMEM;
+	} else if (!(addr = get_unmapped_area(len)))
+		return -ENOMEM;
+	if (!(vma = get_empty_vma()))
+		return -ENOMEM;
+	vma->start = addr;
+	vma->end = addr + len;
+	if ((vma->inode = inode))
+		inode->i_count++;
+	vma->offset = off;
+	vma->prot = prot;
+	vma->flags = flags;
+	return addr;
+}
+
+int sys_munmap(unsigned long addr, unsigned long len)
+{
+	len = (len + 0xfff) & 0xfffff000;
+	if (!len || (addr & 0xfff) || addr + len < addr)
+		return -EINVAL;
+	return do_munmap(addr,len);
+}
+
+/*
+ * exit_mmap() forgets all areas of a task, on exit and exec. Their pages
+ * go with the rest of the page tables, so only the inodes are released.
+ */
+void exit_mmap(struct task_struct * p)
+{
+	struct vm_area * vma;
+
+	for (vma = p->mmap ; vma < p->mmap + NR_VMA ; vma++)
+		if (vma->end) {
+			iput(vma->inode);
+			vma->inode = NULL;
+			vma->end = 0;
+		}
+}
@@ -0,0 +1,260 @@
+/*
+ *  linux/mm/page_ops.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+/*
+ * Page-sized copies and clears are what most of the kernel's data
+ * movement comes down to: every get_free_page() clears a page, and every
+ * copy-on-write fault copies one. Besides the plain "rep ; movsl" ones
+ * there are MMX and SSE2 versions, and page_ops_init() times all those
+ * the cpu has at boot (with the time stamp counter, if there is one) and
+ * uses the fastest.
+ *
+ * The MMX and SSE2 versions can be called from anywhere, interrupts
+ * included, so they save the fpu/xmm registers they use on the stack,
+ * and turn on what they need in cr0/cr4 only while they run. OSFXSR in
+ * particular stays off otherwise: user programs still don't get SSE, as
+ * we don't save their xmm registers.
+ */
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <asm/system.h>
+
+#define rdtsc(low) \
+__asm__ __volatile__("rdtsc":"=a" (low)::"dx")
+
+static void copy_page_movsl(unsigned long from, unsigned long to)
+{
+	int d0,d1,d2;
+
+	__asm__ __volatile__("cld ; rep ; movsl"
+		:"=&c" (d0),"=&S" (d1),"=&D" (d2)
+		:"0" (PAGE_SIZE/4),"1" (from),"2" (to)
+		:"memory");
+}
+
+static void clear_page_movsl(unsigned long page)
+{
+	int d0,d1;
+
+	__asm__ __volatile__("cld ; rep ; stosl"
+		:"=&c" (d0),"=&D" (d1)
+		:"a" (0),"0" (PAGE_SIZE/4),"1" (page)
+		:"memory");
+}
+
+/*
+ * fnsave also re-initializes the fpu, so the MMX code starts with a
+ * clean state, and frstor puts back the tag word that MMX messes up.
+ */
+#define mmx_begin(cr0,buf) \
+__asm__ __volatile__("movl %%cr0,%0\n\t" \
+	"clts\n\t" \
+	"fnsave %1" \
+	:"=&r" (cr0),"=m" (buf))
+
+#define mmx_end(cr0,buf) \
+__asm__ __volatile__("frstor %1\n\t" \
+	"movl %0,%%cr0" \
+	::"r" (cr0),"m" (buf):"memory")
+
+static void copy_page_mmx(unsigned long from, unsigned long to)
+{
+	char fpu[108];
+	unsigned long cr0;
+	int i;
+
+	mmx_begin(cr0,fpu);
+	for (i=0 ; i<PAGE_SIZE/64 ; i++,from += 64,to += 64)
+		__asm__ __volatile__("movq (%0),%%mm0\n\t"
+			"movq 8(%0),%%mm1\n\t"
+			"movq 16(%0),%%mm2\n\t"
+			"movq 24(%0),%%mm3\n\t"
+			"movq 32(%0),%%mm4\n\t"
+			"movq 40(%0),%%mm5\n\t"
+			"movq 48(%0),%%mm6\n\t"
+			"movq 56(%0),%%mm7\n\t"
+			"movq %%mm0,(%1)\n\t"
+			"movq %%mm1,8(%1)\n\t"
+			"movq %%mm2,16(%1)\n\t"
+			"movq %%mm3,24(%1)\n\t"
+			"movq %%mm4,32(%1)\n\t"
+			"movq %%mm5,40(%1)\n\t"
+			"movq %%mm6,48(%1)\n\t"
+			"movq %%mm7,56(%1)"
+			::"r" (from),"r" (to):"memory");
+	mmx_end(cr0,fpu);
+}
+
+static void clear_page_mmx(unsigned long page)
+{
+	char fpu[108];
+	unsigned long cr0;
+	int i;
+
+	mmx_begin(cr0,fpu);
+	__asm__ __volatile__("pxor %mm0,%mm0");
+	for (i=0 ; i<PAGE_SIZE/64 ; i++,page += 64)
+		__asm__ __volatile__("movq %%mm0,(%0)\n\t"
+			"movq %%mm0,8(%0)\n\t"
+			"movq %%mm0,16(%0)\n\t"
+			"movq %%mm0,24(%0)\n\t"
+			"movq %%mm0,32(%0)\n\t"
+			"movq %%mm0,40(%0)\n\t"
+			"movq %%mm0,48(%0)\n\t"
+			"movq %%mm0,56(%0)"
+			::"r" (page):"memory");
+	mmx_end(cr0,fpu);
+}
+
+/* only xmm0-xmm3 are used, so only they are saved */
+#define sse_begin(cr0,cr4,buf) \
+__asm__ __volatile__("movl %%cr0,%0\n\t" \
+	"clts\n\t" \
+	"movl %%cr4,%1\n\t" \
+	"movl %1,%%eax\n\t" \
+	"orl $0x200,%%eax\n\t" \
+	"movl %%eax,%%cr4\n\t" \
+	"movups %%xmm0,(%2)\n\t" \
+	"movups %%xmm1,16(%2)\n\t" \
+	"movups %%xmm2,32(%2)\n\t" \
+	"movups %%xmm3,48(%2)" \
+	:"=&r" (cr0),"=&r" (cr4):"r" (buf):"ax","memory")
+
+#define sse_end(cr0,cr4,buf) \
+__asm__ __volatile__("sfence\n\t" \
+	"movups (%2),%%xmm0\n\t" \
+	"movups 16(%2),%%xmm1\n\t" \
+	"movups 32(%2),%%xmm2\n\t" \
+	"movups 48(%2),%%xmm3\n\t" \
+	"movl %1,%%cr4\n\t" \
+	"movl %0,%%cr0" \
+	::"r" (cr0),"r" (cr4),"r" (buf):"memory")
+
+/* non-temporal stores: the page isn't likely to be read again at once */
+static void copy_page_sse2(unsigned long from, unsigned long to)
+{
+	char xmm[64];
+	unsigned long cr0,cr4;
+	int i;
+
+	sse_begin(cr0,cr4,xmm);
+	for (i=0 ; i<PAGE_SIZE/64 ; i++,from += 64,to += 64)
+		__asm__ __volatile__("movdqa (%0),%%xmm0\n\t"
+			"movdqa 16(%0),%%xmm1\n\t"
+			"movdqa 32(%0),%%xmm2\n\t"
+			"movdqa 48(%0),%%xmm3\n\t"
+			"movntdq %%xmm0,(%1)\n\t"
+			"movntdq %%xmm1,16(%1)\n\t"
+			"movntdq %%xmm2,32(%1)\n\t"
+			"movntdq %%xmm3,48(%1)"
+			::"r" (from),"r" (to):"memory");
+	sse_end(cr0,cr4,xmm);
+}
+
+static void clear_page_sse2(unsigned long page)
+{
+	char xmm[64];
+	unsigned long cr0,cr4;
+	int i;
+
+	sse_begin(cr0,cr4,xmm);
+	__asm__ __volatile__("pxor %xmm0,%xmm0");
+	for (i=0 ; i<PAGE_SIZE/64 ; i++,page += 64)
+		__asm__ __volatile__("movntdq %%xmm0,(%0)\n\t"
+			"movntdq %%xmm0,16(%0)\n\t"
+			"movntdq %%xmm0,32(%0)\n\t"
+			"movntdq %%xmm0,48(%0)"
+			::"r" (page):"memory");
+	sse_end(cr0,cr4,xmm);
+}
+
+#define CPU_TSC		0x00000010
+#define CPU_MMX		0x00800000
+#define CPU_SSE2	0x04000000
+
+static struct page_ops {
+	char * name;
+	unsigned long need;	/* cpuid feature flags */
+	void (*copy)(unsigned long from, unsigned long to);
+	void (*clear)(unsigned long page);
+} page_ops[] = {
+	{ "movsl", 0, copy_page_movsl, clear_page_movsl },
+	{ "mmx", CPU_MMX, copy_page_mmx, clear_page_mmx },
+	{ "sse2", CPU_SSE2, copy_page_sse2, clear_page_sse2 },
+	{ NULL, 0, NULL, NULL }
+};
+
+void (*copy_page)(unsigned long from, unsigned long to) = copy_page_movsl;
+void (*clear_page)(unsigned long page) = clear_page_movsl;
+
+#define BENCH_RUNS 16
+
+/*
+ * page_ops_init() is called once memory and the console are set up. The
+ * benchmark takes the best of a few runs of each, so that it's the cached
+ * case that counts - the same as for most of the real copies.
+ */
+void page_ops_init(void)
+{
+	struct page_ops * p;
+	unsigned long eax,ebx,ecx,features = 0;
+	unsigned long from,to,t0,t1,copy,clear;
+	unsigned long best_copy = ~0UL, best_clear = ~0UL;
+	unsigned long cr0;
+	int i;
+
+	if (has_cpuid()) {
+		cpuid(0,eax,ebx,ecx,features);
+		features = 0;
+		if (eax >= 1)
+			cpuid(1,eax,ebx,ecx,features);
+	}
+	__asm__("movl %%cr0,%0":"=r" (cr0));
+	if (cr0 & 4)		/* no math chip: no MMX or SSE either */
+		features &= ~(CPU_MMX | CPU_SSE2);
+	for (p = page_ops ; p->name ; p++)
+		if ((features & p->need) == p->need) {
+			copy_page = p->copy;
+			clear_page = p->clear;
+		}
+	if (!(features & CPU_TSC))
+		return;
+	from = get_free_page();
+	to = get_free_page();
+	if (!from || !to)
+		goto out;
+	for (p = page_ops ; p->name ; p++) {
+		if ((features & p->need) != p->need)
+			continue;
+		copy = clear = ~0UL;
+		for (i=0 ; i<BENCH_RUNS ; i++) {
+			rdtsc(t0);
+			p->copy(from,to);
+			rdtsc(t1);
+			if (t1 - t0 < copy)
+				copy = t1 - t0;
+			rdtsc(t0);
+			p->clear(to);
+			rdtsc(t1);
+			if (t1 - t0 < clear)
+				clear = t1 - t0;
+		}
+		printk("page ops %s: copy %d, clear %d cycles\n\r",
+			p->name,copy,clear);
+		if (copy < best_copy) {
+			best_copy = copy;
+			copy_page = p->copy;
+		}
+		if (clear < best_clear) {
+			best_clear = clear;
+			clear_page = p->clear;
+		}
+	}
+out:
+	free_page(from);
+	free_page(to);
+}
@@ -0,0 +1,294 @@
+/*
+ *  linux/mm/swap.c
+ *
+ *  (C) 1991  Linus Torvalds
+ */
+
+/*
+ * This file should contain most things doing the swapping from/to disk.
+ *
+ * The swap device is a hard disk partition (or the ram disk) set up with
+ * a bitmap in its first page: bit n set means page n of the device is
+ * usable swap-space, and the last 10 bytes of the page have to be
+ * "SWAP-SPACE". Page 0 itself is never used for swapping, so a swap
+ * entry of 0 means "no page".
+ *
+ * A swapped-out page is kept in its page table entry as the swap page
+ * number shifted left one, so that the present bit is clear.
+ */
+
+#include <linux/config.h>
+#include <linux/sched.h>
+#include <linux/head.h>
+#include <linux/kernel.h>
+#include <linux/mm.h>
+#include <asm/system.h>
+
+#include <signal.h>
+
+#define SWAP_BITS (4096<<3)
+
+void do_exit(long code);
+
+#define bitop(name,op) \
+static inline int name(char * addr,unsigned int nr) \
+{ \
+int __res; \
+__asm__ __volatile__("bt" op " %1,%2; adcl $0,%0" \
+:"=g" (__res) \
+:"r" (nr),"m" (*(addr)),"0" (0)); \
+return __res; \
+}
+
+bitop(bit,"")
+bitop(setbit,"s")
+bitop(clrbit,"r")
+
+#ifdef SWAP_DEV
+int swap_dev = SWAP_DEV;
+#else
+int swap_dev = 0;
+#endif
+
+static char * swap_bitmap = NULL;
+
+/*
+ * We never page out task 0 (the kernel), and only look at the user part
+ * of the other tasks' page directories.
+ */
+#define FIRST_VM_DIR (TASK_BASE>>22)
+#define LAST_VM_DIR ((TASK_BASE+TASK_SIZE)>>22)
+#define VM_PAGES ((LAST_VM_DIR - FIRST_VM_DIR)<<10)
+
+#define read_swap_page(nr,buffer) ll_rw_page(READ,swap_dev,(nr),(buffer))
+#define write_swap_page(nr,buffer) ll_rw_page(WRITE,swap_dev,(nr),(buffer))
+
+static int get_swap_page(void)
+{
+	int nr;
+
+	if (!swap_bitmap)
+		return 0;
+	for (nr = 1; nr < SWAP_BITS ; nr++)
+		if (clrbit(swap_bitmap,nr))
+			return nr;
+	return 0;
+}
+
+void swap_free(int swap_nr)
+{
+	if (!swap_nr)
+		return;
+	if (swap_bitmap && swap_nr < SWAP_BITS)
+		if (!setbit(swap_bitmap,swap_nr))
+			return;
+	printk("Swap-space bad (swap_free())\n\r");
+	return;
+}
+
+/*
+ * swap_in() reads the page that the (non-present) page table entry at
+ * table_ptr refers to back into memory, and frees its swap page.
+ * Returns 0 if out of memory. If the page can't be read, the task has
+ * lost it, and is killed.
+ */
+int swap_in(unsigned long *table_ptr)
+{
+	int swap_nr;
+	unsigned long page;
+
+	if (!swap_bitmap) {
+		printk("Trying to swap in without swap bit-map");
+		return 1;
+	}
+	if (1 & *table_ptr) {
+		printk("trying to swap in present page\n\r");
+		return 1;
+	}
+	swap_nr = *table_ptr >> 1;
+	if (!swap_nr) {
+		printk("No swap page in swap_in\n\r");
+		return 1;
+	}
+	if (!(page = get_free_page()))
+		return 0;
+	if (!read_swap_page(swap_nr, (char *) page)) {
+		free_page(page);
+		do_exit(SIGSEGV);
+	}
+	if (setbit(swap_bitmap,swap_nr))
+		printk("swapping in multiply from same page\n\r");
+	*table_ptr = page | (PAGE_DIRTY | 7);
+	return 1;
+}
+
+/*
+ * swap_fork() is used by copy_page_tables() for entries that are swapped
+ * out: the child gets the swap page, and the parent gets its page back
+ * in memory. Returns 0 if out of memory, or if the page can't be read.
+ */
+int swap_fork(unsigned long * from, unsigned long * to)
+{
+	unsigned long page;
+
+	if (!(page = get_free_page()))
+		return 0;
+	if (!read_swap_page(*from >> 1, (char *) page)) {
+		free_page(page);
+		return 0;
+	}
+	*to = *from;
+	*from = page | (PAGE_DIRTY | 7);
+	return 1;
+}
+
+/*
+ * try_to_swap_out() tries to free the page at table_ptr. Pages that have
+ * been used since we last looked get a second chance. Clean pages are
+ * simply dropped: they can be read from the executable or mmap()ed file
+ * (or are zero) when needed again. Pages that can't, like the exec
+ * arguments and copy-on-write copies, are mapped dirty from the start.
+ * Dirty ones are written to the swap device, unless they are shared.
+ */
+static int try_to_swap_out(unsigned long * table_ptr)
+{
+	unsigned long page, old, table;
+	int swap_nr, ok;
+
+	page = *table_ptr;
+	if (!(PAGE_PRESENT & page))
+		return 0;
+	if (page - LOW_MEM > PAGING_MEMORY)
+		return 0;
+	if (PAGE_ACCESSED & page) {
+		*table_ptr &= ~PAGE_ACCESSED;
+		return 0;
+	}
+	if (PAGE_DIRTY & page) {
+		page &= 0xfffff000;
+		if (mem_map[MAP_NR(page)] != 1)
+			return 0;
+		if (!(swap_nr = get_swap_page()))
+			return 0;
+/*
+ * Writing it out sleeps, so the page stays mapped meanwhile: read-only,
+ * so that we see if it gets changed. We hang on to the page table too,
+ * in case the task goes away. If the write fails, it just stays.
+ */
+		table = 0xfffff000 & (unsigned long) table_ptr;
+		mem_map[MAP_NR(table)]++;
+		old = *table_ptr;
+		*table_ptr = old & ~PAGE_RW;
+		invalidate();
+		ok = write_swap_page(swap_nr, (char *) page);
+		if ((*table_ptr & ~PAGE_ACCESSED) != (old & ~PAGE_RW) ||
+		    mem_map[MAP_NR(page)] != 1)
+			ok = 0;
+		else if (ok) {
+			*table_ptr = swap_nr<<1;
+			invalidate();
+			free_page(page);
+		} else
+			*table_ptr |= old & PAGE_RW;
+		if (!ok)
+			swap_free(swap_nr);
+		free_page(table);
+		return ok;
+	}
+	*table_ptr = 0;
+	invalidate();
+	free_page(0xfffff000 & page);
+	return 1;
+}
+
+/*
+ * swap_out() is a clock: it goes on from where it stopped last time,
+ * over the page tables of all tasks, until it has freed a page or gone
+ * twice around (the first round may only clear accessed bits). The page
+ * directory entry is looked up again every time, as try_to_swap_out()
+ * can sleep and the task go away.
+ */
+int swap_out(void)
+{
+	static int swap_task = 1;
+	static int dir_nr = FIRST_VM_DIR;
+	static int page_nr = 0;
+	int counter = 2*(NR_TASKS-1)*VM_PAGES;
+	struct task_struct * p;
+	unsigned long pg_table;
+
+	if (!swap_bitmap)
+		return 0;
+	while (counter > 0) {
+		if (page_nr >= 1024) {
+			page_nr = 0;
+			if (++dir_nr >= LAST_VM_DIR) {
+				dir_nr = FIRST_VM_DIR;
+				if (++swap_task >= NR_TASKS)
+					swap_task = 1;
+			}
+		}
+		if (!(p = task[swap_task])) {
+			counter -= VM_PAGES;
+			dir_nr = LAST_VM_DIR;
+			page_nr = 1024;
+			continue;
+		}
+		pg_table = ((unsigned long *) p->tss.cr3)[dir_nr];
+		if (!(pg_table & 1)) {
+			counter -= 1024;
+			page_nr = 1024;
+			continue;
+		}
+		pg_table &= 0xfffff000;
+		while (page_nr < 1024 && counter-- > 0)
+			if (try_to_swap_out(page_nr++ + (unsigned long *) pg_table))
+				return 1;
+	}
+	printk("Out of swap-memory\n\r");
+	return 0;
+}
+
+/*
+ * init_swapping() is called from sys_setup(), once the partition
+ * tables are known.
+ */
+void init_swapping(void)
+{
+	static char signature[] = "SWAP-SPACE";
+	int i,j;
+
+	if (!swap_dev)
+		return;
+	swap_bitmap = (char *) get_free_page();
+	if (!swap_bitmap) {
+		printk("Unable to start swapping: out of memory :-)\n\r");
+		goto no_swap;
+	}
+	if (!read_swap_page(0,swap_bitmap)) {
+		printk("Unable to read swap-space bit-map\n\r");
+		goto no_swap;
+	}
+	for (i=0 ; i<10 ; i++)
+		if (swap_bitmap[4086+i] != signature[i]) {
+			printk("Unable to find swap-space signature\n\r");
+			goto no_swap;
+		}
+	for (i=0 ; i<10 ; i++)
+		swap_bitmap[4086+i] = 0;
+	if (bit(swap_bitmap,0)) {
+		printk("Bad swap-space bit-map\n\r");
+		goto no_swap;
+	}
+	j = 0;
+	for (i = 1 ; i < SWAP_BITS ; i++)
+		if (bit(swap_bitmap,i))
+			j++;
+	if (!j)
+		goto no_swap;
+	printk("Swap device ok: %d pages (%d bytes) swap-space\n\r",j,j*4096);
+	return;
+no_swap:
+	free_page((long) swap_bitmap);
+	swap_bitmap = NULL;
+}